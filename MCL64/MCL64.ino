@@ -12,7 +12,8 @@
 //
 // The acceleration modes can be changed via the UART from the host.
 // Entering a 0,1,2,3 will change the acceleration mode to this value
-// and it will be echoed back to the host.
+// and it will be echoed back to the host.  Mode 4 is adaptive and
+// promotes pages from mode 1 to mode 2 or 3 as they prove safe.
 //
 // Entering mode 2 or 4 could result in video corruption, but the CPU will still 
 // be running.  When returning to mode-0 or mode-1 the video should return to normal.
@@ -47,6 +48,66 @@
 // - When set to 0, forces cycle-accurate mode and removes internal RAM array
 // - resulting in improved cartridge compatibility
 // 
+// ========================================================================
+// Revision 5 10/18/2026
+// - Posted-write queue: write-through RAM writes in modes 2 and 3 no longer
+//   stall the CPU, they drain on later CLK cycles and are flushed before
+//   any external read or I/O access
+// - Split-phase writes: start_write_byte()/finish_write_byte() mirror
+//   start_read()/finish_read_byte() so read-modify-write opcodes run their
+//   ALU operation while the dummy write cycle is on the bus
+// - IRQ, NMI and RESET are sampled once per instruction when running from
+//   internal memory; MEASURE_IRQ_LATENCY reports latency per mode with 'L'
+// - UART commands with arguments (letter, arguments, CR/LF) alongside the
+//   single-digit mode select
+// - Target-speed throttle paced by the DWT cycle counter, 'T<n>' for n MHz
+// - Reads of raster, VIC interrupt and CIA timer registers drop modes 2/3
+//   to cycle-accurate mode 1 for 'W<n>' instructions
+// - PC-range policy table checked at opcode fetch; defaults keep the KERNAL
+//   serial bus and tape routines cycle-accurate, extended with 'P'
+// - internal_address_check() is a page map lookup; per-program profiles in
+//   EEPROM (program_profiles.h) select mode, throttle and page caps by the
+//   signature of the code started with SYS or RUN
+// - phi2_cycles counts CLK rising edges seen by the bus interface
+// - Adaptive mode 4 starts every page cycle-accurate and promotes pages
+//   that read back clean, keeping the VIC bank write-through; pages whose
+//   bus data disagrees with internal memory are demoted to mode 0
+// - VIC and SID registers are shadowed (io_shadow.h) so reads of stable
+//   registers in modes 2-4 do not take a bus cycle
+// - Color RAM is shadowed the same way, the upper nibble of a read comes
+//   from the last byte seen on the bus
+// - Virtual CIA timers (virtual_cia.h, 'V1') count in the core's cycle
+//   domain so delay loops polling a CIA without interrupts run accelerated
+// - Raster estimator (raster_estimator.h) predicts badlines and sprite DMA
+//   and holds posted writes while the VIC has the bus
+// - CBM80 cartridges are detected at RESET and their ROML/ROMH copied
+//   (cartridge.h) until a write to $DE00-$DFFF switches banks
+// - .crt images in flash (cart_images.cpp) can be served in place of a
+//   cartridge with 'C<n>', including Ocean, Magic Desk and EasyFlash banking
+// - ENABLE_REU adds a 17xx REU at $DF00 backed by PSRAM (reu.h) whose
+//   transfers complete between instructions; its registers are off while
+//   an EasyFlash image holds $DF00
+// - Native routine traps (native_traps.h) run C++ handlers in place of
+//   6502 routines at registered addresses, switched with 'N<n>'
+// - BASIC FADD, FSUB, FMULT and FDIV run natively (basic_float.h) with
+//   the ROM's rounding and zero page side effects
+// - SIN, COS, TAN, ATN, LOG, EXP, SQR and the power operator run natively
+//   (basic_functions.h) with results identical to the ROM series
+// - FIN and FOUT run natively (basic_convert.h), so literals, VAL, PRINT
+//   and STR$ convert numbers without the 6502 code
+// - GOTO, GOSUB and THEN find their line by a binary search of a line
+//   index (basic_lines.h) that is dropped when the program text changes
+// - PTRGET finds variables and arrays through hash tables (basic_variables.h)
+//   that are dropped when variables are created or moved
+// - String garbage collection runs natively in one pass (basic_garbage.h)
+//   and leaves string space exactly as the ROM's repeated scans do
+// - NEXT steps and tests its loop natively and FNDFOR searches the stack
+//   for FOR frames natively (basic_loops.h)
+// - BLTU moves BASIC memory blocks natively, with memmove() when both
+//   blocks are in internal memory (basic_memory.h)
+// - CHRGET and CHRGOT in zero page run natively while their code is the
+//   KERNAL's (basic_chrget.h)
+//
 //------------------------------------------------------------------------
 //
 // Copyright (c) 2021 Ted Fried
@@ -78,12 +139,38 @@
 // --------------------------------------------------------------------------------------------------
 #define ENABLE_ACCELERATION 0    // 1 = Include acceleration features, 0 = Original cycle-accurate only
 
+// 17xx REU emulation at $DF00 (reu.h), requires ENABLE_ACCELERATION and a PSRAM chip fitted to the Teensy
+#define ENABLE_REU  0
+#define REU_SIZE_KB 512          // 128 (1700), 256 (1764), 512 (1750) up to 16384
+
+// Throttle multipliers accepted by the 'T' UART command and the profiles, as multiples of 1 MHz (0 = unlimited)
+#define THROTTLE_MAX 20
+
+// VIC timing used by the raster estimator (raster_estimator.h)
+#define RASTER_NTSC 0            // 1 = 6567 NTSC VIC, 0 = 6569 PAL VIC
+
 #include "basic_rom.h"
 #include "kernal_rom.h"
 #include "opcodes.h"
 #include "opcode_dispatch.h"
 #include "addressing_modes.h"
 #include "hardware_config.h"
+#include "program_profiles.h"
+#include "virtual_cia.h"
+#include "io_shadow.h"
+#include "raster_estimator.h"
+#include "cartridge.h"
+#include "reu.h"
+#include "native_traps.h"
+#include "basic_float.h"
+#include "basic_functions.h"
+#include "basic_convert.h"
+#include "basic_lines.h"
+#include "basic_variables.h"
+#include "basic_garbage.h"
+#include "basic_loops.h"
+#include "basic_memory.h"
+#include "basic_chrget.h"
 
 // Memory page and banking macros 
 #define Page_128_159  ( (current_address >= 0x8000) && (current_address <= 0x9FFF) ) ? 0x1 : 0x0 
@@ -98,6 +185,34 @@
 // This eliminates most of the superfluous fetches and writes of the cycle-accurate 6502
 #define SPEEDUP 0
 
+// Measure IRQ latency with a pin-change interrupt on the IRQ line, reported with 'L' over the UART
+// Leave at 0 for normal use since the interrupt adds jitter to the bus interface
+#define MEASURE_IRQ_LATENCY 0
+
+// Instructions to run cycle-accurate after a read of a raster, VIC interrupt or CIA timer register
+// in modes 2 and 3 (changed with 'W<n>' over the UART, 0 disables the fallback)
+#define TIMING_FALLBACK_WINDOW 200
+
+// PC-range acceleration policies checked at opcode fetch
+#define PC_POLICY_ENTRIES         16
+#define PC_POLICY_CYCLE_ACCURATE  0x0    // Run cycle-accurate (mode 1 when an accelerated mode is selected)
+#define PC_POLICY_CAP_SPEED       0x1    // Limit the throttle to the entry's speed in MHz
+#define PC_POLICY_ACCELERATE      0x2    // Run at the selected mode and throttle
+#define PC_POLICY_NONE            0xFF
+
+// Depth of the posted-write queue used for write-through RAM in modes 2 and 3 (must be a power of two)
+#define POSTED_WRITE_DEPTH 8
+
+// Adaptive acceleration (mode 4) - verified level-1 reads a page must see before it is promoted
+#define MODE_ADAPTIVE              0x4
+#define ADAPTIVE_PROMOTE_READS     64
+#define ADAPTIVE_DMA_STALL         64     // READY low for longer than a badline means expansion port DMA
+
+// Posted-write bus states
+#define PW_IDLE       0x0      // Nothing on the bus, next queued write is issued on a CLK rising edge
+#define PW_DRIVE_OE   0x1      // Address and data driven, waiting for the CLK falling edge
+#define PW_RETIRE     0x2      // Data drivers enabled, waiting for the CLK rising edge
+
 
 // CPU register for direct reads of the GPIOs 
 uint8_t   current_p=0x7;        
@@ -118,18 +233,81 @@ uint8_t   assert_sync=0;
 uint8_t   global_temp=0;
 uint8_t   last_access_internal_RAM=0;
 uint8_t   ea_data=0;
+uint8_t   write_cycle_in_flight=0;
 #if ENABLE_ACCELERATION
 uint8_t   mode=0;
+uint8_t   accel_mode=0;             // Mode in effect for this instruction after automatic fallbacks
 #else
 #define   mode 0     // Force mode 0 at compile time
 #endif
 
+uint32_t  phi2_cycles=0;          // CLK rising edges seen by the bus interface
+
 uint16_t  register_pc=0;
 uint16_t  current_address=0;
 uint16_t  effective_address=0;
 
 #if ENABLE_ACCELERATION
 uint8_t   internal_RAM[65536];
+
+uint16_t  posted_write_address[POSTED_WRITE_DEPTH];
+uint8_t   posted_write_data[POSTED_WRITE_DEPTH];
+uint8_t   posted_write_head=0;
+uint8_t   posted_write_tail=0;
+uint8_t   posted_write_count=0;
+uint8_t   posted_write_state=PW_IDLE;
+uint8_t   posted_write_clk=0;
+uint8_t   posted_write_flushing=0;  // Set while flush_posted_writes() drains the queue for an external access
+
+uint8_t   page_access_map[5][512];  // internal_address_check() result per mode for each 128-byte block
+uint8_t   page_cap[256];            // Highest access level allowed for each page, set by program profiles
+
+uint8_t   adaptive_level[256];      // Access level reached by each page in mode 4
+uint8_t   adaptive_reads[256];      // Verified level-1 reads seen since the page was last promoted
+uint8_t   adaptive_ready_low=0;     // Consecutive CLK edges with READY low
+uint8_t   adaptive_recheck_pending=0;
+uint8_t   cia2_pra=0xFF;            // CIA2 port A and its direction register, snooped for the VIC bank
+uint8_t   cia2_ddra=0x00;
+uint8_t   vic_bank_page=0x00;       // First page of the 16KB bank the VIC is fetching from
+
+uint32_t  internal_cycles=0;        // 6502 cycles completed from internal memory without a bus cycle
+uint8_t   throttle=0;               // Target speed as a multiple of 1 MHz, 0 = unlimited
+uint8_t   throttle_in_effect=0;     // Throttle after PC policy speed caps
+uint32_t  throttle_ticks_per_cycle=0;
+uint32_t  throttle_deadline=0;
+uint32_t  throttle_cycles_seen=0;
+
+uint16_t  timing_fallback_window=TIMING_FALLBACK_WINDOW;
+uint16_t  timing_fallback_count=0;
+
+struct pc_policy_entry {
+  uint16_t  start;
+  uint16_t  end;
+  uint8_t   policy;
+  uint8_t   speed;
+};
+
+// Defaults protect the stock KERNAL_ROM serial bus and tape routines
+const pc_policy_entry pc_policy_defaults[] = {
+  { 0xED09, 0xEEBA, PC_POLICY_CYCLE_ACCURATE, 0 },              // IEC serial bus - TALK/LISTEN, byte send/receive, delays
+  { 0xF72C, 0xFCE1, PC_POLICY_CYCLE_ACCURATE, 0 },              // Tape - header search, read/write IRQ handlers
+};
+#define PC_POLICY_DEFAULTS (sizeof(pc_policy_defaults)/sizeof(pc_policy_entry))
+pc_policy_entry pc_policy_table[PC_POLICY_ENTRIES];
+uint8_t   pc_policy_count=0;
+uint8_t   pc_policy_page[256];      // Number of policy entries touching each 256-byte page of PC
+
+char      serial_command[32];
+uint8_t   serial_command_length=0;
+
+#if MEASURE_IRQ_LATENCY
+volatile uint32_t irq_assert_time=0;     // DWT count when the IRQ line was asserted, 0 when no IRQ is outstanding
+uint32_t  irq_latency_last[5];
+uint32_t  irq_latency_max[5];
+uint32_t  irq_latency_count[5];
+
+void irq_line_asserted();
+#endif
 #endif
 extern const uint8_t BASIC_ROM[0x2000];
 extern const uint8_t KERNAL_ROM[0x2000];
@@ -146,6 +324,21 @@ void setup() {
   digitalWriteFast(PIN_P2, 0x1 ); 
 
   Serial.begin(9600);  
+
+#if ENABLE_ACCELERATION
+  ARM_DEMCR    |= ARM_DEMCR_TRCENA;                                 // Enable the DWT cycle counter
+  ARM_DWT_CTRL |= ARM_DWT_CTRL_CYCCNTENA;
+
+  memset(page_cap, 0x3, sizeof(page_cap));
+  memset(adaptive_level, 0x1, sizeof(adaptive_level));
+  rebuild_page_access_map();
+  raster_estimator_reset();
+  load_program_profiles();
+  native_traps_init();
+#endif
+#if ENABLE_ACCELERATION && MEASURE_IRQ_LATENCY
+  attachInterrupt(digitalPinToInterrupt(PIN_IRQ), irq_line_asserted, RISING);
+#endif
 }
 
 
@@ -159,27 +352,79 @@ void setup() {
 
 
 // ----------------------------------------------------------
-// Address range check
+// Address range rules for each acceleration mode
 //  Return: 0x0 - All exernal memory accesses
 //          0x1 - Reads and writes are cycle accurate using internal memory with writes passing through to motherboard
 //          0x2 - Reads accelerated using internal memory and writes are cycle accurate and pass through to motherboard
 //          0x3 - All read and write accesses use accelerated internal memory 
+//
+// Mode 4 (adaptive) uses the mode-3 rules as a ceiling for the level each
+// page has reached.
 // ----------------------------------------------------------
-inline uint8_t internal_address_check(uint16_t local_address) {
-
 #if ENABLE_ACCELERATION
-  if ( (local_address > 0x0001 ) && (local_address <= 0x03FF) ) return mode;            //   Zero-Page up to video 
-  if ( (local_address >= 0x0400) && (local_address <= 0x07FF) && mode>1) return 0x1;    //   C64 Video Memory 
-  if ( (local_address >= 0x0800) && (local_address <= 0x7FFF) ) return mode;            //   C64 RAM 
-  if ( (local_address >= 0x8000) && (local_address <= 0x9FFF) ) return mode;            //   C64 CART_LOW & RAM 
-  if ( (local_address >= 0xA000) && (local_address <= 0xBFFF) ) return mode;            //   C64 BASIC ROM & RAM
-  if ( (local_address >= 0xC000) && (local_address <= 0xCFFF) ) return mode;            //   C64 RAM
-//if ( (local_address >= 0xD000) && (local_address <= 0xDFFF) ) return 0x0;             //   C64 I/O
-  if ( (local_address >= 0xE000) && (local_address <= 0xE4FF) ) return mode;            //   C64 KERNAL ROM  
-  if ( (local_address >= 0xE500) && (local_address <= 0xFF7F) && mode>1) return 0x1;    //   C64 KERNAL ROM  
-  if ( (local_address >= 0xFF80) && (local_address <= 0xFFFF) ) return mode;            //   C64 KERNAL ROM 
+uint8_t address_range_access(uint8_t local_mode, uint16_t local_address) {
+
+  if ( (local_address > 0x0001 ) && (local_address <= 0x03FF) ) return local_mode;            //   Zero-Page up to video 
+  if ( (local_address >= 0x0400) && (local_address <= 0x07FF) && local_mode>1) return 0x1;    //   C64 Video Memory 
+  if ( (local_address >= 0x0800) && (local_address <= 0x7FFF) ) return local_mode;            //   C64 RAM 
+  if ( (local_address >= 0x8000) && (local_address <= 0x9FFF) ) return local_mode;            //   C64 CART_LOW & RAM 
+  if ( (local_address >= 0xA000) && (local_address <= 0xBFFF) ) return local_mode;            //   C64 BASIC ROM & RAM
+  if ( (local_address >= 0xC000) && (local_address <= 0xCFFF) ) return local_mode;            //   C64 RAM
+//if ( (local_address >= 0xD000) && (local_address <= 0xDFFF) ) return 0x0;                  //   C64 I/O
+  if ( (local_address >= 0xE000) && (local_address <= 0xE4FF) ) return local_mode;            //   C64 KERNAL ROM  
+  if ( (local_address >= 0xE500) && (local_address <= 0xFF7F) && local_mode>1) return 0x1;    //   C64 KERNAL ROM  
+  if ( (local_address >= 0xFF80) && (local_address <= 0xFFFF) ) return local_mode;            //   C64 KERNAL ROM 
  
   return 0x0;
+}
+
+
+// ----------------------------------------------------------
+// Build the page map from the range rules for every mode, limited by
+// the per-page caps.  The map has 128-byte entries so the $FF80 split
+// in the KERNAL range is kept.
+// ----------------------------------------------------------
+uint8_t page_access_level(uint8_t local_mode, uint16_t half_page) {
+  uint16_t local_address;
+  uint8_t  access;
+  uint8_t  cart;
+
+  local_address = (half_page==0) ? 0x0002 : (half_page<<7);
+  if (local_mode==MODE_ADAPTIVE) {
+    access = address_range_access(0x3, local_address);
+    if (access > adaptive_level[half_page>>1]) access = adaptive_level[half_page>>1];
+  }
+  else access = address_range_access(local_mode, local_address);
+  if (access > page_cap[half_page>>1]) access = page_cap[half_page>>1];
+
+  cart = cart_page_access(half_page>>1);                           // Cartridge ROM overrides the caps
+  if (cart==0x0) access = 0x0;
+  else if (cart==0x1 && access==0x0) access = 0x1;
+  return access;
+}
+
+void rebuild_page_access_map() {
+  uint8_t  local_mode;
+  uint16_t half_page;
+
+  for (local_mode=0; local_mode<5; local_mode++) {
+    for (half_page=0; half_page<512; half_page++) {
+      page_access_map[local_mode][half_page] = page_access_level(local_mode, half_page);
+    }
+  }
+  return;
+}
+#endif
+
+
+// ----------------------------------------------------------
+// Address range check - one page map lookup for the mode in effect
+// ----------------------------------------------------------
+inline uint8_t internal_address_check(uint16_t local_address) {
+
+#if ENABLE_ACCELERATION
+  if (local_address <= 0x0001) return 0x0;                         //   6510 I/O port
+  return page_access_map[accel_mode][local_address>>7];
 #else
   // No acceleration - always return 0x0 (external memory only)
   return 0x0;
@@ -187,6 +432,31 @@ inline uint8_t internal_address_check(uint16_t local_address) {
 } 
 
 
+#if ENABLE_ACCELERATION
+// ----------------------------------------------------------
+// Timing register read check
+//  Reads of the VIC raster and interrupt registers and the CIA timer,
+//  TOD and interrupt status registers mean the code is polling real
+//  time, so the following instructions are run cycle-accurate.
+// ----------------------------------------------------------
+inline void timing_register_check(uint16_t local_address) {
+  uint8_t reg;
+
+  if ( ((bank_mode&0x4)==0) || ((bank_mode&0x3)==0) ) return;    // I/O not mapped in
+
+  if ( (local_address & 0xFC00) == 0xD000 )  {                   // VIC registers mirrored every 64 bytes
+    reg = local_address & 0x3F;
+    if (reg==0x11 || reg==0x12 || reg==0x19) timing_fallback_count = timing_fallback_window;
+  }
+  else if ( (local_address & 0xFE00) == 0xDC00 )  {              // CIA1 and CIA2 registers mirrored every 16 bytes
+    reg = local_address & 0x0F;
+    if ( (reg>=0x4 && reg<=0xB) || reg==0xD ) timing_fallback_count = timing_fallback_window;
+  }
+  return;
+}
+#endif
+
+
 // -------------------------------------------------
 // Wait for the CLK1 rising edge and sample signals
 // -------------------------------------------------
@@ -198,6 +468,7 @@ inline void wait_for_CLK_rising_edge() {
     while (((GPIO6_DR >> 12) & 0x1)!=0) {}            // Teensy 4.1 Pin-24  GPIO6_DR[12]     CLK
     
     while (((GPIO6_DR >> 12) & 0x1)==0) {GPIO6_data=GPIO6_DR;}                  // This method is ok for VIC-20 and Apple-II+ non-DRAM ranges 
+    phi2_cycles++;
     
     //do {  GPIO6_data_d1=GPIO6_DR;   } while (((GPIO6_data_d1 >> 12) & 0x1)==0);   // This method needed to support Apple-II+ DRAM read data setup time
     //GPIO6_data=GPIO6_data_d1;
@@ -216,6 +487,10 @@ inline void wait_for_CLK_rising_edge() {
     
     direct_datain = d76 | d5 | d4 | d3 | d2 | d10;
     
+#if ENABLE_ACCELERATION
+    if (direct_ready_n==0) adaptive_ready_low = 0;                   // DMA check for adaptive mode
+    else if (adaptive_ready_low<ADAPTIVE_DMA_STALL && ++adaptive_ready_low==ADAPTIVE_DMA_STALL && mode==MODE_ADAPTIVE) adaptive_recheck_pending = 1;
+#endif
     return; 
 }
 
@@ -231,6 +506,21 @@ inline void wait_for_CLK_falling_edge() {
 }
 
 
+// -------------------------------------------------
+// Sample the interrupt and reset lines without waiting for a CLK edge
+// Used when execution runs from internal memory and no bus cycles
+// are refreshing them.
+// -------------------------------------------------
+inline void sample_interrupt_lines() {
+  register uint32_t GPIO6_data=GPIO6_DR;
+
+    direct_irq      = (GPIO6_data&0x00002000) >> 13;  // Teensy 4.1 Pin-25  GPIO6_DR[13]     IRQ
+    direct_reset    = (GPIO6_data&0x00100000) >> 20;  // Teensy 4.1 Pin-40  GPIO6_DR[20]     RESET
+    direct_nmi      = (GPIO6_data&0x00200000) >> 21;  // Teensy 4.1 Pin-41  GPIO6_DR[21]     NMI
+    return;
+}
+
+
 // -------------------------------------------------
 // Drive the 6502 Address pins
 // -------------------------------------------------
@@ -264,6 +554,269 @@ inline void send_address(uint32_t local_address) {
     return;
 }
 
+
+// -------------------------------------------------
+// Drive the address and data pins for a write cycle
+// -------------------------------------------------
+inline void start_write(uint16_t local_address , uint8_t local_write_data) {
+
+    digitalWriteFast(PIN_RDWR_n,  0x0);
+    send_address(local_address);
+
+    // Drive the data bus pins from the Teensy to the bus driver which is inactive
+    //
+    digitalWriteFast(PIN_DATAOUT0,  (local_write_data & 0x01)    );
+    digitalWriteFast(PIN_DATAOUT1,  (local_write_data & 0x02)>>1 ); 
+    digitalWriteFast(PIN_DATAOUT2,  (local_write_data & 0x04)>>2 ); 
+    digitalWriteFast(PIN_DATAOUT3,  (local_write_data & 0x08)>>3 ); 
+    digitalWriteFast(PIN_DATAOUT4,  (local_write_data & 0x10)>>4 ); 
+    digitalWriteFast(PIN_DATAOUT5,  (local_write_data & 0x20)>>5 ); 
+    digitalWriteFast(PIN_DATAOUT6,  (local_write_data & 0x40)>>6 ); 
+    digitalWriteFast(PIN_DATAOUT7,  (local_write_data & 0x80)>>7 ); 
+
+    if (local_address==0x1) {  
+      current_p = local_write_data;
+      digitalWriteFast(PIN_P0,  (local_write_data & 0x01) ); 
+      digitalWriteFast(PIN_P1,  (local_write_data & 0x02) >> 1 ); 
+      digitalWriteFast(PIN_P2,  (local_write_data & 0x04) >> 2 ); 
+    }
+    return;
+}
+
+
+#if ENABLE_ACCELERATION
+// -------------------------------------------------
+// Posted writes
+//
+// In modes 2 and 3 writes to write-through RAM update internal_RAM
+// immediately and are queued for the motherboard.  The queue is advanced
+// by polling the CLK level between internal accesses so the CPU keeps
+// executing while the bus cycles complete.  Each write is issued on a
+// rising edge, its data drivers are enabled on the falling edge and it
+// retires on the next rising edge, exactly as write_byte() does.  While
+// READY is low the VIC is taking the bus for a badline or sprite DMA, so
+// the data drivers are held off until a falling edge with READY high.
+// -------------------------------------------------
+inline void poll_posted_writes() {
+  uint32_t GPIO6_data;
+  uint8_t clk;
+  uint8_t ready_n;
+  uint8_t rising, falling;
+
+    GPIO6_data = GPIO6_DR;
+    clk     = (GPIO6_data >> 12) & 0x1;                  // Teensy 4.1 Pin-24  GPIO6_DR[12]     CLK
+    ready_n = (GPIO6_data >> 30) & 0x1;                  // Teensy 4.1 Pin-26  GPIO6_DR[30]     READY
+    rising  = (posted_write_clk==0 && clk==1);
+    falling = (posted_write_clk==1 && clk==0);
+    posted_write_clk = clk;
+
+    switch (posted_write_state) {
+      case PW_DRIVE_OE:
+        if (falling && ready_n==0) {
+          digitalWriteFast(PIN_DATAOUT_OE_n,  0x0 );
+          posted_write_state = PW_RETIRE;
+        }
+        break;
+
+      case PW_RETIRE:
+        if (rising) {
+          digitalWriteFast(PIN_DATAOUT_OE_n,  0x1 );
+          posted_write_tail = (posted_write_tail+1) & (POSTED_WRITE_DEPTH-1);
+          posted_write_count--;
+          posted_write_state = PW_IDLE;
+        }
+        else break;
+        // fall through - the next queued write can be issued on this same rising edge
+
+      case PW_IDLE:
+        if (posted_write_count==0) {
+          if (rising) digitalWriteFast(PIN_RDWR_n,  0x1);  // Release R/W so idle cycles are reads
+        }
+        else if (rising) {
+          if (posted_write_flushing==0 && posted_write_count<POSTED_WRITE_DEPTH && raster_stall_predicted()) {
+            digitalWriteFast(PIN_RDWR_n,  0x1);          // Hold while the VIC has the bus, idle cycles are reads
+            break;
+          }
+          start_write(posted_write_address[posted_write_tail], posted_write_data[posted_write_tail]);
+          posted_write_state = PW_DRIVE_OE;
+        }
+        break;
+    }
+    return;
+}
+
+
+// -------------------------------------------------
+// Complete all queued writes before an external access
+// -------------------------------------------------
+inline void flush_posted_writes() {
+
+    if (posted_write_count==0) return;
+
+    posted_write_flushing=1;
+    while (posted_write_count!=0) poll_posted_writes();
+    posted_write_flushing=0;
+    digitalWriteFast(PIN_RDWR_n,  0x1);
+    last_access_internal_RAM=0;                          // Queue retired on a rising edge so the bus is already in step
+    return;
+}
+
+
+// -------------------------------------------------
+// Queue a write-through write for the motherboard
+// -------------------------------------------------
+inline void post_write(uint16_t local_address , uint8_t local_write_data) {
+
+    if (posted_write_count==0) posted_write_clk = (GPIO6_DR >> 12) & 0x1;   // Resample so a stale level is not seen as an edge
+    while (posted_write_count==POSTED_WRITE_DEPTH) poll_posted_writes();
+
+    posted_write_address[posted_write_head] = local_address;
+    posted_write_data[posted_write_head]    = local_write_data;
+    posted_write_head = (posted_write_head+1) & (POSTED_WRITE_DEPTH-1);
+    posted_write_count++;
+    return;
+}
+
+
+// -------------------------------------------------
+// Adaptive acceleration (mode 4)
+//
+// Every page starts at level 1 where reads are cycle-accurate, so the
+// byte on the bus can be compared with internal memory.  A page that sees
+// ADAPTIVE_PROMOTE_READS verified reads is promoted to level 3, or to
+// level 2 while it is in the VIC bank so the VIC still sees its writes.
+// A mismatch means something other than the CPU changes the page (or a
+// different ROM is fitted) so the page drops to level 0 until mode 4 is
+// selected again, and the read returns the data from the bus.
+//
+// Promoted pages are checked again after a VIC bank change, for the pages
+// of both banks, and after READY has been low for longer than a badline,
+// which means a cartridge has taken the bus for DMA.  They go back to
+// level 1, with level-3 pages written back to the motherboard first.
+// -------------------------------------------------
+void set_adaptive_level(uint8_t page, uint8_t level) {
+
+    adaptive_level[page] = level;
+    adaptive_reads[page] = 0;
+    page_access_map[MODE_ADAPTIVE][page<<1]     = page_access_level(MODE_ADAPTIVE, page<<1);
+    page_access_map[MODE_ADAPTIVE][(page<<1)+1] = page_access_level(MODE_ADAPTIVE, (page<<1)+1);
+    return;
+}
+
+// Copy a page from internal_RAM to the motherboard once its writes have stopped passing through
+void write_back_page(uint8_t page) {
+  uint16_t local_address = page<<8;
+
+    do {
+      if (local_address>0x0001) post_write(local_address, internal_RAM[local_address]);
+      local_address++;
+    } while ((local_address&0xFF)!=0);
+    return;
+}
+
+void begin_adaptive_mode() {
+  uint16_t page;
+
+    for (page=0; page<256; page++) {
+      if (page_access_map[mode][page<<1]>0x2 || page_access_map[mode][(page<<1)+1]>0x2) write_back_page(page);
+    }
+    flush_posted_writes();
+    memset(adaptive_level, 0x1, sizeof(adaptive_level));
+    memset(adaptive_reads, 0, sizeof(adaptive_reads));
+    adaptive_recheck_pending = 0;
+    rebuild_page_access_map();
+    return;
+}
+
+// Send a promoted page back to level 1 to be verified again
+void adaptive_recheck_page(uint8_t page) {
+
+    if (adaptive_level[page]<0x2) return;
+    if (adaptive_level[page]>0x2) write_back_page(page);
+    set_adaptive_level(page, 0x1);
+    return;
+}
+
+// Called between instructions after DMA was seen
+void adaptive_recheck_all() {
+  uint16_t page;
+
+    adaptive_recheck_pending = 0;
+    for (page=0; page<256; page++) adaptive_recheck_page(page);
+    return;
+}
+
+// Is the byte at current_address read from RAM rather than a ROM?
+inline uint8_t adaptive_read_is_ram() {
+    if (Page_128_159==0x1) return !CART_ROML_MAPPED;
+    if (Page_160_191==0x1) return !CART_ROMH_MAPPED && (bank_mode&0x3)!=0x3;
+    if (Page_224_255==0x1) return !CART_ULTIMAX_MAPPED && (bank_mode&0x2)!=0x2;
+    return 1;
+}
+
+inline void adaptive_count_read(uint8_t page) {
+  uint8_t level;
+
+    if (++adaptive_reads[page] < ADAPTIVE_PROMOTE_READS) return;
+    level = ((page&0xC0)==vic_bank_page) ? 0x2 : 0x3;
+    if (level>adaptive_level[page]) set_adaptive_level(page, level);
+    else adaptive_reads[page] = 0;
+    return;
+}
+
+// Return: the byte the CPU reads
+inline uint8_t adaptive_observe_read(uint8_t internal_data) {
+
+    if (internal_data==direct_datain) {
+      adaptive_count_read(current_address>>8);
+      return internal_data;
+    }
+    set_adaptive_level(current_address>>8, 0x0);
+    if (adaptive_read_is_ram()) internal_RAM[current_address] = direct_datain;
+    return direct_datain;
+}
+
+// Writes to CIA2 port A or its direction register can move the VIC to another
+// 16KB bank.  Promoted pages of the old and the new bank are verified again.
+void snoop_cia2_write(uint16_t local_address , uint8_t local_write_data) {
+  uint8_t page;
+  uint8_t old_page;
+
+    if ( ((bank_mode&0x4)==0) || ((bank_mode&0x3)==0) ) return;    // I/O not mapped in
+
+    if      ((local_address&0xF)==0x0) cia2_pra  = local_write_data;
+    else if ((local_address&0xF)==0x2) cia2_ddra = local_write_data;
+    else return;
+
+    page = (0x3 - ((cia2_pra | ~cia2_ddra) & 0x3)) << 6;           // Inputs are pulled high
+    if (page==vic_bank_page) return;
+    old_page = vic_bank_page;
+    vic_bank_page = page;
+
+    if (mode!=MODE_ADAPTIVE) return;
+    do {
+      adaptive_recheck_page(page);
+      adaptive_recheck_page(old_page);
+      page++;
+      old_page++;
+    } while ((page&0x3F)!=0);
+    return;
+}
+
+
+// -------------------------------------------------
+// Change the acceleration mode
+// -------------------------------------------------
+void select_mode(uint8_t new_mode) {
+
+    if (new_mode>MODE_ADAPTIVE) new_mode = 0x0;
+    flush_posted_writes();
+    if (new_mode==MODE_ADAPTIVE) begin_adaptive_mode();
+    mode = new_mode;
+    return;
+}
+#endif
+
         
 // -------------------------------------------------
 // Send the address for a read cyle
@@ -279,6 +832,7 @@ inline void start_read(uint32_t local_address) {
 
     else 
     {
+       flush_posted_writes();
        if (last_access_internal_RAM==1) wait_for_CLK_rising_edge();
        last_access_internal_RAM=0;
 
@@ -301,10 +855,15 @@ inline void start_read(uint32_t local_address) {
 inline uint8_t fetch_byte_from_bank() {
                      
 #if ENABLE_ACCELERATION
-    if (Page_160_191==0x1)  {  if   ((bank_mode&0x3)==0x3)                                  {  return BASIC_ROM[current_address & 0x1FFF];        }
+    if (Page_128_159==0x1)  {  if   (CART_ROML_MAPPED)                                      {  return cart_roml_bank[current_address & 0x1FFF];   }
+                               else                                                         {  return internal_RAM[current_address];              }  }
+
+    if (Page_160_191==0x1)  {  if   (CART_ROMH_MAPPED)                                      {  return cart_romh_bank[current_address & 0x1FFF];   }
+                               else if ((bank_mode&0x3)==0x3)                               {  return BASIC_ROM[current_address & 0x1FFF];        }
                                else                                                         {  return internal_RAM[current_address];              }  }
     
-    if (Page_224_255==0x1)  {  if ( (bank_mode&0x2)==0x2)                                   {  return KERNAL_ROM[current_address & 0x1FFF];       }
+    if (Page_224_255==0x1)  {  if   (CART_ULTIMAX_MAPPED)                                   {  return cart_romh_bank[current_address & 0x1FFF];   }
+                               else if ( (bank_mode&0x2)==0x2)                              {  return KERNAL_ROM[current_address & 0x1FFF];       }
                                else                                                         {  return internal_RAM[current_address];              }  }
     
      return internal_RAM[current_address];
@@ -325,18 +884,25 @@ inline uint8_t fetch_byte_from_bank() {
 inline uint8_t finish_read_byte() {  
   
 #if ENABLE_ACCELERATION
+  uint8_t local_data;
+
   if (internal_address_check(current_address)>0x1)  {
     last_access_internal_RAM=1;
+    internal_cycles++;
+    if (posted_write_count!=0) poll_posted_writes();
     return fetch_byte_from_bank();   
     }         
     else 
     {
+       flush_posted_writes();
        if (last_access_internal_RAM==1) wait_for_CLK_rising_edge();
        last_access_internal_RAM=0;
        
        do {  wait_for_CLK_rising_edge();  }  while (direct_ready_n == 0x1);  // Delay a clock cycle until ready is active 
                       
-       if (internal_address_check(current_address)>0x0)  {  return fetch_byte_from_bank();   }
+       if (internal_address_check(current_address)>0x0)  {  local_data = fetch_byte_from_bank();
+                                                            if (accel_mode==MODE_ADAPTIVE) local_data = adaptive_observe_read(local_data);
+                                                            return local_data;  }
        else                                              {  if (current_address==0x1) return (current_p|0x10); else return direct_datain;                  }
     }
 #else
@@ -353,25 +919,48 @@ inline uint8_t finish_read_byte() {
 // -------------------------------------------------
 // Full read cycle with address and data read in
 // -------------------------------------------------
-inline uint8_t read_byte(uint16_t local_address) {  
+uint8_t read_byte(uint16_t local_address) {  
   
   current_address = local_address;
   
 #if ENABLE_ACCELERATION
+  uint8_t local_data;
+
   if (internal_address_check(local_address)>0x1)  {
     last_access_internal_RAM=1;
+    internal_cycles++;
+    if (posted_write_count!=0) poll_posted_writes();
         return fetch_byte_from_bank(); 
     }
+    else if (accel_mode>1 && (local_address&0xF000)==0xD000 && io_shadow_read(local_address, &local_data))  {
+      last_access_internal_RAM=1;                                            // I/O register answered from its shadow
+      internal_cycles++;
+      if (posted_write_count!=0) poll_posted_writes();
+      return local_data;
+    }
     else 
     {
+       flush_posted_writes();
        if (last_access_internal_RAM==1) wait_for_CLK_rising_edge();
        last_access_internal_RAM=0;
        
        start_read(local_address);
        do {  wait_for_CLK_rising_edge();  }  while (direct_ready_n == 0x1);  // Delay a clock cycle until ready is active 
 
-       if (internal_address_check(current_address)>0x0)  {  return fetch_byte_from_bank();  }
-       else                                              {  if (current_address==0x1) return (current_p|0x10); else return direct_datain;                  }
+       if (internal_address_check(current_address)>0x0)  {  local_data = fetch_byte_from_bank();
+                                                            if (accel_mode==MODE_ADAPTIVE) local_data = adaptive_observe_read(local_data);
+                                                            return local_data;  }
+       else                                              {  if (current_address==0x1) return (current_p|0x10); 
+                                                            if ((current_address&0xF000)==0xD000) {
+                                                              io_shadow_fill(current_address, direct_datain);
+                                                              raster_observe_read(current_address, direct_datain);
+#if ENABLE_REU
+                                                              if ((current_address&0xFF00)==0xDF00 && reu_io_read(current_address, &local_data)) return local_data;
+#endif
+                                                              if ((current_address&0xFE00)==0xDE00 && cart_io_read(current_address, &local_data)) return local_data;
+                                                              if (mode>1) timing_register_check(current_address);
+                                                            }
+                                                            return direct_datain;                  }
      }
 #else
   // Original cycle-accurate only
@@ -384,89 +973,134 @@ inline uint8_t read_byte(uint16_t local_address) {
 } 
 
 
+#if ENABLE_ACCELERATION
+// -------------------------------------------------
+// Read cycle on the bus regardless of the page map
+// -------------------------------------------------
+uint8_t read_byte_external(uint16_t local_address) {
+
+    flush_posted_writes();
+    if (last_access_internal_RAM==1) wait_for_CLK_rising_edge();
+    last_access_internal_RAM=0;
+
+    current_address = local_address;
+    digitalWriteFast(PIN_RDWR_n,  0x1);
+    send_address(local_address);
+    do {  wait_for_CLK_rising_edge();  }  while (direct_ready_n == 0x1);  // Delay a clock cycle until ready is active 
+    return direct_datain;
+}
+#endif
+
+
 // -------------------------------------------------
-// Full write cycle with address and data written
+// Issue a write cycle
+//
+// Writes that complete internally (or are posted) finish here.  An
+// external write is left in flight with address and data driven so the
+// caller can do independent work before finish_write_byte() retires it.
 // -------------------------------------------------
-inline void write_byte(uint16_t local_address , uint8_t local_write_data) {
+void start_write_byte(uint16_t local_address , uint8_t local_write_data) {
   
 #if ENABLE_ACCELERATION
   // Internal RAM
   //
     if (internal_address_check(local_address)>0x2)  {
     last_access_internal_RAM=1;
+    internal_cycles++;
     internal_RAM[local_address] = local_write_data;
+    if (posted_write_count!=0) poll_posted_writes();
       //if ( (Page_128_159==0x1)  && ( (EXROM==1 && GAME==0) || ( EXROM==0 && ((bank_mode&0x3)==0x3) ) )) {  } else internal_RAM[local_address] = local_write_data; 
   }
+  
+  // Write-through RAM in the accelerated modes is posted so execution continues while the bus write completes
+  //
+  else if (accel_mode>1 && internal_address_check(local_address)>0x0)  {
+    last_access_internal_RAM=1;
+    internal_cycles++;
+    internal_RAM[local_address] = local_write_data;
+    post_write(local_address, local_write_data);
+    poll_posted_writes();
+  }
   else 
   {
+       if ((local_address&0xFF00)==0xDD00) snoop_cia2_write(local_address, local_write_data);   // VIC bank select, before the write reaches the bus
+       if ((local_address&0xFE00)==0xDE00) cart_io_write(local_address, local_write_data);       // Cartridge bank switching
+#if ENABLE_REU
+       if ((local_address&0xFF00)==0xDF00) reu_io_write(local_address, local_write_data);
+#endif
+       if ((local_address&0xF000)==0xD000) io_shadow_write(local_address, local_write_data);
+       flush_posted_writes();
        if (last_access_internal_RAM==1) wait_for_CLK_rising_edge();
        last_access_internal_RAM=0;
        internal_RAM[local_address] = local_write_data;
       //if ( (Page_128_159==0x1)  && ( (EXROM==1 && GAME==0) || ( EXROM==0 && ((bank_mode&0x3)==0x3) ) )) {  } else internal_RAM[local_address] = local_write_data; 
      
-       digitalWriteFast(PIN_RDWR_n,  0x0);
-       send_address(local_address);
-
-       
-     // Drive the data bus pins from the Teensy to the bus driver which is inactive
-     //
-       digitalWriteFast(PIN_DATAOUT0,  (local_write_data & 0x01)    );
-       digitalWriteFast(PIN_DATAOUT1,  (local_write_data & 0x02)>>1 ); 
-       digitalWriteFast(PIN_DATAOUT2,  (local_write_data & 0x04)>>2 ); 
-       digitalWriteFast(PIN_DATAOUT3,  (local_write_data & 0x08)>>3 ); 
-       digitalWriteFast(PIN_DATAOUT4,  (local_write_data & 0x10)>>4 ); 
-       digitalWriteFast(PIN_DATAOUT5,  (local_write_data & 0x20)>>5 ); 
-       digitalWriteFast(PIN_DATAOUT6,  (local_write_data & 0x40)>>6 ); 
-       digitalWriteFast(PIN_DATAOUT7,  (local_write_data & 0x80)>>7 ); 
-     
-       if (local_address==0x1) {  
-       current_p = local_write_data;
-       digitalWriteFast(PIN_P0,  (local_write_data & 0x01) ); 
-       digitalWriteFast(PIN_P1,  (local_write_data & 0x02) >> 1 ); 
-       digitalWriteFast(PIN_P2,  (local_write_data & 0x04) >> 2 ); 
-     }
-     
-       
-       // During the second CLK phase, enable the data bus output drivers
-       //
-       wait_for_CLK_falling_edge();
-       digitalWriteFast(PIN_DATAOUT_OE_n,  0x0 ); 
-       
-       wait_for_CLK_rising_edge();
-       digitalWriteFast(PIN_DATAOUT_OE_n,  0x1 );   
+       start_write(local_address, local_write_data);
+       write_cycle_in_flight=1;
   }
 #else
   // Original cycle-accurate only - always external write
-  digitalWriteFast(PIN_RDWR_n,  0x0);
-  send_address(local_address);
-
-  // Drive the data bus pins from the Teensy to the bus driver which is inactive
-  digitalWriteFast(PIN_DATAOUT0,  (local_write_data & 0x01)    );
-  digitalWriteFast(PIN_DATAOUT1,  (local_write_data & 0x02)>>1 ); 
-  digitalWriteFast(PIN_DATAOUT2,  (local_write_data & 0x04)>>2 ); 
-  digitalWriteFast(PIN_DATAOUT3,  (local_write_data & 0x08)>>3 ); 
-  digitalWriteFast(PIN_DATAOUT4,  (local_write_data & 0x10)>>4 ); 
-  digitalWriteFast(PIN_DATAOUT5,  (local_write_data & 0x20)>>5 ); 
-  digitalWriteFast(PIN_DATAOUT6,  (local_write_data & 0x40)>>6 ); 
-  digitalWriteFast(PIN_DATAOUT7,  (local_write_data & 0x80)>>7 ); 
-
-  if (local_address==0x1) {  
-    current_p = local_write_data;
-    digitalWriteFast(PIN_P0,  (local_write_data & 0x01) ); 
-    digitalWriteFast(PIN_P1,  (local_write_data & 0x02) >> 1 ); 
-    digitalWriteFast(PIN_P2,  (local_write_data & 0x04) >> 2 ); 
-  }
+  start_write(local_address, local_write_data);
+  write_cycle_in_flight=1;
+#endif            
+   return;
+}
+
+
+// -------------------------------------------------
+// Retire an external write cycle
+// -------------------------------------------------
+void finish_write_byte() {
+
+  if (write_cycle_in_flight==0) return;
+  write_cycle_in_flight=0;
 
   // During the second CLK phase, enable the data bus output drivers
+  //
   wait_for_CLK_falling_edge();
   digitalWriteFast(PIN_DATAOUT_OE_n,  0x0 ); 
   
   wait_for_CLK_rising_edge();
   digitalWriteFast(PIN_DATAOUT_OE_n,  0x1 );   
-#endif            
+  return;
+}
+
+
+// -------------------------------------------------
+// Full write cycle with address and data written
+// -------------------------------------------------
+void write_byte(uint16_t local_address , uint8_t local_write_data) {
+
+   start_write_byte(local_address, local_write_data);
+   finish_write_byte();
+#if ENABLE_ACCELERATION
+   if (local_address<line_index_watch_end) line_index_write(local_address);   // Program text changed
+   if (local_address<var_index_watch_end)  var_index_write(local_address);    // Variable names or sizes changed
+#endif
+#if ENABLE_ACCELERATION && ENABLE_REU
+   if (reu_armed) reu_check_trigger(local_address);             // Transfers start after the command write or the write to $FF00
+#endif
    return;
 }
 
+
+#if ENABLE_ACCELERATION
+// -------------------------------------------------
+// Write cycle on the bus regardless of the page map
+// -------------------------------------------------
+void write_byte_external(uint16_t local_address , uint8_t local_write_data) {
+
+    flush_posted_writes();
+    if (last_access_internal_RAM==1) wait_for_CLK_rising_edge();
+    last_access_internal_RAM=0;
+
+    start_write(local_address, local_write_data);
+    write_cycle_in_flight=1;
+    finish_write_byte();
+    return;
+}
+#endif
+
   
 // --------------------------------------------------------------------------------------------------
 // --------------------------------------------------------------------------------------------------
@@ -517,12 +1151,58 @@ void Begin_Fetch_Next_Opcode()  {
     return;
 }
 
+#if ENABLE_ACCELERATION && MEASURE_IRQ_LATENCY
+// -------------------------------------------------
+// IRQ latency measurement
+// -------------------------------------------------
+void irq_line_asserted() {
+    if (irq_assert_time==0) irq_assert_time = ARM_DWT_CYCCNT | 0x1;
+    return;
+}
+
+void record_irq_latency() {
+    uint32_t latency;
+
+    if (irq_assert_time==0) return;
+    latency = ARM_DWT_CYCCNT - irq_assert_time;
+    irq_assert_time = 0;
+
+    irq_latency_last[mode] = latency;
+    if (latency > irq_latency_max[mode]) irq_latency_max[mode] = latency;
+    irq_latency_count[mode]++;
+    return;
+}
+
+void report_irq_latency() {
+    uint8_t  m;
+    uint32_t ticks_per_us = F_CPU_ACTUAL / 1000000;
+
+    for (m=0; m<5; m++) {
+      Serial.print("M");           Serial.print(m);
+      Serial.print(" IRQs=");      Serial.print(irq_latency_count[m]);
+      Serial.print(" last_ns=");   Serial.print(irq_latency_last[m] * 1000 / ticks_per_us);
+      Serial.print(" max_ns=");    Serial.println(irq_latency_max[m] * 1000 / ticks_per_us);
+    }
+    return;
+}
+#endif
+
+
 // -------------------------------------------------
 // Reset sequence for the 6502
 // -------------------------------------------------
 void reset_sequence() {
     uint16_t temp1, temp2;
        
+#if ENABLE_ACCELERATION
+    flush_posted_writes();                                          // Retire any queued writes before the bus is reset
+    io_shadow_reset();
+    virtual_cia_reset();
+    raster_estimator_reset();
+#endif
+#if ENABLE_ACCELERATION && ENABLE_REU
+    reu_reset();
+#endif
     while (digitalReadFast(PIN_RESET)!=0) {}                        // Stay here until RESET deasserts
             
                 
@@ -533,6 +1213,10 @@ void reset_sequence() {
     digitalWriteFast(PIN_P1, 0x1 ); 
     digitalWriteFast(PIN_P2, 0x1 );           
             
+#if ENABLE_ACCELERATION
+    cart_overlay_reset();
+    detect_cartridge();                                             // Copy a CBM80 cartridge's ROM before the CPU starts
+#endif
             
     temp1 = read_byte(register_pc);                                 // Address ??
     temp1 = read_byte(register_pc+1);                               // Address ?? + 1
@@ -588,6 +1272,9 @@ void nmi_handler() {
 void irq_handler(uint8_t opcode_is_brk) {
     uint16_t temp1, temp2;
     
+#if ENABLE_ACCELERATION && MEASURE_IRQ_LATENCY
+    if (opcode_is_brk==0) record_irq_latency();
+#endif
     wait_for_CLK_rising_edge();                                     // Begin processing on next CLK edge
                         
     register_flags = register_flags | 0x20;                         // Set the flag[5]          
@@ -613,6 +1300,227 @@ void irq_handler(uint8_t opcode_is_brk) {
 // --------------------------------------------------------------------------------------------------
 
 
+#if ENABLE_ACCELERATION
+// -------------------------------------------------
+// Target-speed throttle
+//
+// Each 6502 cycle, run from internal memory or on the bus, advances a
+// deadline on the DWT cycle counter by 1/throttle microseconds and
+// execution waits for it.  Bus cycles are the CLK edges the CPU waited
+// for in phi2_cycles.  They take a microsecond each, so when execution
+// falls behind the deadline is pulled forward instead of letting the
+// core burst to catch up.
+// -------------------------------------------------
+inline uint32_t throttle_cycles() {
+    return internal_cycles + phi2_cycles;
+}
+
+void apply_throttle(uint8_t multiplier) {
+    throttle_in_effect = multiplier;
+    if (multiplier!=0) throttle_ticks_per_cycle = F_CPU_ACTUAL / (1000000 * (uint32_t)multiplier);
+    throttle_cycles_seen = throttle_cycles();
+    throttle_deadline    = ARM_DWT_CYCCNT;
+    return;
+}
+
+void set_throttle(uint8_t multiplier) {
+    throttle = multiplier;
+    apply_throttle(multiplier);
+    return;
+}
+
+inline void pace_execution() {
+  uint32_t now;
+  uint32_t cycles = throttle_cycles();
+
+    throttle_deadline   += (cycles - throttle_cycles_seen) * throttle_ticks_per_cycle;
+    throttle_cycles_seen = cycles;
+
+    now = ARM_DWT_CYCCNT;
+    if ((int32_t)(now - throttle_deadline) > 0) { 
+      throttle_deadline = now; 
+    }
+    else {
+      while ((int32_t)(ARM_DWT_CYCCNT - throttle_deadline) < 0) {
+        if (posted_write_count!=0) poll_posted_writes();   // Use the idle time to drain queued writes
+      }
+    }
+    return;
+}
+
+
+// -------------------------------------------------
+// PC-range acceleration policies
+//
+// pc_policy_page[] flags the pages that have an entry so the common
+// case at opcode fetch is one table read.  Later entries take priority
+// so ranges added over the UART can override the defaults.
+// -------------------------------------------------
+void rebuild_pc_policy_pages() {
+  uint8_t  i;
+  uint16_t page;
+
+    memset(pc_policy_page, 0, sizeof(pc_policy_page));
+    for (i=0; i<pc_policy_count; i++) {
+      for (page=(pc_policy_table[i].start>>8); page<=(pc_policy_table[i].end>>8); page++) pc_policy_page[page]++;
+    }
+    return;
+}
+
+// Replace the table with the defaults, also used by 'PD'
+void restore_pc_policy_defaults() {
+    memcpy(pc_policy_table, pc_policy_defaults, sizeof(pc_policy_defaults));
+    pc_policy_count = PC_POLICY_DEFAULTS;
+    rebuild_pc_policy_pages();
+    return;
+}
+
+inline uint8_t pc_policy_lookup(uint16_t local_pc) {
+  uint8_t i;
+
+    if (pc_policy_page[local_pc>>8]==0) return PC_POLICY_NONE;
+
+    for (i=pc_policy_count; i>0; i--) {
+      if (local_pc>=pc_policy_table[i-1].start && local_pc<=pc_policy_table[i-1].end) return i-1;
+    }
+    return PC_POLICY_NONE;
+}
+
+void report_pc_policies() {
+  uint8_t i;
+
+    for (i=0; i<pc_policy_count; i++) {
+      Serial.print("P");  Serial.print(pc_policy_table[i].start, HEX);
+      Serial.print(",");  Serial.print(pc_policy_table[i].end, HEX);
+      Serial.print(",");  Serial.print(pc_policy_table[i].policy);
+      Serial.print(",");  Serial.println(pc_policy_table[i].speed);
+    }
+    return;
+}
+
+
+// -------------------------------------------------
+// UART command channel
+//
+// A single 0,1,2,3,4 sets the acceleration mode immediately as before.
+// Other commands are a letter followed by arguments and end with CR/LF.
+// -------------------------------------------------
+uint32_t parse_serial_number(char **text, uint8_t base) {
+  uint32_t value=0;
+  uint8_t  digit;
+
+    while (**text==' ' || **text==',') (*text)++;
+    while (1) {
+      if      (**text>='0' && **text<='9')             digit = **text - '0';
+      else if (base==16 && **text>='A' && **text<='F') digit = **text - 'A' + 10;
+      else if (base==16 && **text>='a' && **text<='f') digit = **text - 'a' + 10;
+      else break;
+      value = value*base + digit;
+      (*text)++;
+    }
+    return value;
+}
+
+void process_serial_command() {
+  char     *text = &serial_command[1];
+  uint32_t value;
+
+    switch (serial_command[0]) {
+      case 'T': case 't':                                       // T<n> - Throttle to n MHz, T0 = unlimited
+        value = parse_serial_number(&text, 10);
+        if (value>THROTTLE_MAX) value = THROTTLE_MAX;
+        set_throttle(value);
+        Serial.print("T");  Serial.println(throttle);
+        break;
+
+#if MEASURE_IRQ_LATENCY
+      case 'L': case 'l':                                       // L - Report IRQ latency per mode
+        report_irq_latency(); 
+        break;
+#endif
+
+      case 'N': case 'n':                                       // N<n> - Native routine traps, N1 = on, N0 = off, N = report
+        if (*text!=0) native_traps_enabled = (parse_serial_number(&text, 10)!=0);
+        Serial.print("N");  Serial.print(native_traps_enabled);
+        Serial.print(" traps=");  Serial.print(native_trap_count);
+        Serial.print(" hits=");   Serial.println(native_trap_hits);
+        break;
+
+      case 'P': case 'p':                                       // P - List, PX - Clear, PD - Defaults, P<start>,<end>,<policy>[,<mhz>] - Add
+        if (*text==0) { 
+          report_pc_policies(); 
+          break; 
+        }
+        if (*text=='X' || *text=='x') pc_policy_count = 0;
+        else if (*text=='D' || *text=='d') restore_pc_policy_defaults();
+        else if (pc_policy_count<PC_POLICY_ENTRIES) {
+          pc_policy_table[pc_policy_count].start  = parse_serial_number(&text, 16);
+          pc_policy_table[pc_policy_count].end    = parse_serial_number(&text, 16);
+          pc_policy_table[pc_policy_count].policy = parse_serial_number(&text, 10);
+          pc_policy_table[pc_policy_count].speed  = parse_serial_number(&text, 10);
+          if (pc_policy_table[pc_policy_count].start <= pc_policy_table[pc_policy_count].end) pc_policy_count++;
+        }
+        rebuild_pc_policy_pages();
+        report_pc_policies();
+        break;
+
+      case 'C': case 'c':                                       // C - Cartridge images, see cartridge.h
+        process_cartridge_command(text);
+        break;
+
+      case 'F': case 'f':                                       // F - Program profiles, see program_profiles.h
+        process_profile_command(text);
+        break;
+
+      case 'V': case 'v':                                       // V<n> - Virtual CIA timers, V1 = on, V0 = off
+        virtual_cia = (parse_serial_number(&text, 10)!=0);
+        Serial.print("V");  Serial.println(virtual_cia);
+        break;
+
+      case 'W': case 'w':                                       // W<n> - Cycle-accurate window after a timing register read
+        timing_fallback_window = parse_serial_number(&text, 10);
+        timing_fallback_count  = 0;
+        Serial.print("W");  Serial.println(timing_fallback_window);
+        break;
+
+      default:
+        Serial.println("?");
+        break;
+    }
+    return;
+}
+
+void serial_command_poll() {
+
+    while (Serial.available()) {
+      incomingByte = Serial.read();
+
+      if (serial_command_length==0 && incomingByte>='0' && incomingByte<='4') {
+        switch (incomingByte){
+          case 48: select_mode(0);  Serial.println("M0"); break;
+          case 49: select_mode(1);  Serial.println("M1"); break;
+          case 50: select_mode(2);  Serial.println("M2"); break;
+          case 51: select_mode(3);  Serial.println("M3"); break;
+          case 52: select_mode(4);  Serial.println("M4"); break;
+        }
+      }
+      else if (incomingByte=='\r' || incomingByte=='\n') {
+        if (serial_command_length!=0) {
+          flush_posted_writes();
+          serial_command[serial_command_length] = 0;
+          process_serial_command();
+          serial_command_length = 0;
+        }
+      }
+      else if (serial_command_length < sizeof(serial_command)-1) {
+        serial_command[serial_command_length++] = incomingByte;
+      }
+    }
+    return;
+}
+#endif
+
+
 // -------------------------------------------------
 //
 // Main loop
@@ -621,6 +1529,13 @@ void irq_handler(uint8_t opcode_is_brk) {
  void loop() {
   
   uint16_t local_counter=0;
+#if ENABLE_ACCELERATION
+  uint8_t  new_accel_mode;
+  uint8_t  new_throttle;
+  uint8_t  pc_policy;
+
+  restore_pc_policy_defaults();
+#endif
   
   // Give Teensy 4.1 a moment
   delay (50);
@@ -641,25 +1556,70 @@ void irq_handler(uint8_t opcode_is_brk) {
       // for acceleration modes 0,1,2,3
       //
       local_counter++;
-      if (local_counter==8000){
-        if (Serial.available() ) { 
-          incomingByte = Serial.read();   
-          switch (incomingByte){
-            case 48: mode=0;  Serial.println("M0"); break;
-            case 49: mode=1;  Serial.println("M1"); break;
-            case 50: mode=2;  Serial.println("M2"); break;
-            case 51: mode=3;  Serial.println("M3"); break;
-          }
-        }
-      }    
+      if (local_counter==8000) serial_command_poll();
+
+      // Select the mode for this instruction.  While a timing register is being polled
+      // the accelerated modes drop to mode 1, which is cycle-accurate but still reads
+      // internal_RAM so it stays coherent with writes made in mode 3.
+      //
+      if ((register_pc==0xE144 || register_pc==0xA871) && profile_program_entry(register_pc)) {   // SYS and RUN
+        start_read(register_pc);                                     // Reissue the opcode fetch under the profile
+      }
+
+      if (adaptive_recheck_pending!=0) {
+        adaptive_recheck_all();
+        start_read(register_pc);                                     // Reissue the opcode fetch under the new levels
+      }
+
+      pc_policy = pc_policy_lookup(register_pc);
+      new_throttle = throttle;
+      if (pc_policy!=PC_POLICY_NONE && pc_policy_table[pc_policy].policy==PC_POLICY_CAP_SPEED) {
+        if (new_throttle==0 || new_throttle>pc_policy_table[pc_policy].speed) new_throttle = pc_policy_table[pc_policy].speed;
+      }
+      if (new_throttle!=throttle_in_effect) apply_throttle(new_throttle);
+
+      if (timing_fallback_count!=0) {
+        timing_fallback_count--;
+        new_accel_mode = (mode>1) ? 0x1 : mode;
+      }
+      else if (pc_policy!=PC_POLICY_NONE && pc_policy_table[pc_policy].policy==PC_POLICY_CYCLE_ACCURATE) {
+        new_accel_mode = (mode>1) ? 0x1 : mode;
+      }
+      else new_accel_mode = mode;
+
+      if (new_accel_mode!=accel_mode) {
+        accel_mode = new_accel_mode;
+        start_read(register_pc);                                     // Reissue the opcode fetch under the new mode
+      }
+
+      // Code running from internal memory sees no CLK edges, so sample the
+      // interrupt lines directly once per instruction
+      //
+      if (last_access_internal_RAM==1) sample_interrupt_lines();
 #endif
     
+      // The opcode fetch issued by the previous instruction is still in flight here,
+      // so the housekeeping above and the interrupt polling below overlap the bus cycle.
+      //
       // Poll for NMI and IRQ
       //
+#if ENABLE_ACCELERATION && ENABLE_REU
+      if (reu_status&0x80) direct_irq = 0x1;                         // REU interrupt is ORed onto the IRQ line
+#endif
       if (nmi_n_old==0 && direct_nmi==1)        nmi_handler();          
       if (direct_irq==0x1  && (flag_i)==0x0)    irq_handler(0x0);   
       nmi_n_old = direct_nmi;                                        
 
+#if ENABLE_ACCELERATION
+      // Routines with a native handler run here in place of the 6502 code.
+      // The cycles of the handler's memory accesses are paced like an instruction's.
+      //
+      if (native_trap_check(register_pc)) {
+        if (throttle_in_effect!=0) pace_execution();
+        continue;
+      }
+#endif
+
     
       next_instruction = finish_read_byte();  
       assert_sync=0;
@@ -667,5 +1627,9 @@ void irq_handler(uint8_t opcode_is_brk) {
       // Change this line:
       execute_opcode(next_instruction);
 
+#if ENABLE_ACCELERATION
+      if (throttle_in_effect!=0) pace_execution();
+#endif
+
     } 
 }
@@ -3,6 +3,8 @@
 // External functions we need
 extern uint8_t read_byte(uint16_t local_address);
 extern void write_byte(uint16_t local_address, uint8_t local_write_data);
+extern void start_write_byte(uint16_t local_address, uint8_t local_write_data);
+extern void finish_write_byte();
 
 // External variables - fix the types to match the main file
 extern uint16_t register_pc, effective_address;
@@ -198,8 +200,14 @@ void Write_Indexed_Indirect_Y(uint8_t local_data)  {
     return;
 }
 
-void Double_WriteBack(uint8_t local_data)  {  
-    if (SPEEDUP==0)  write_byte(effective_address , ea_data);
+// Read-modify-write: the unmodified data is written back first and the
+// ALU operation runs while that bus cycle is in flight, as on the 6502
+void Double_WriteBack(uint8_t (*alu_operation)(uint8_t))  {  
+    uint8_t local_data;
+
+    if (SPEEDUP==0)  start_write_byte(effective_address , ea_data);
+    local_data = alu_operation(ea_data);
+    if (SPEEDUP==0)  finish_write_byte();
     write_byte(effective_address , local_data);
     return;
 }
\ No newline at end of file
@@ -36,6 +36,6 @@ void Write_Absolute_Y(uint8_t local_data);
 void Write_Indexed_Indirect_X(uint8_t local_data);
 void Write_Indexed_Indirect_Y(uint8_t local_data);
 
-void Double_WriteBack(uint8_t local_data);
+void Double_WriteBack(uint8_t (*alu_operation)(uint8_t));
 
 #endif // ADDRESSING_MODES_H
\ No newline at end of file
@@ -0,0 +1,54 @@
+// ============================================================================
+// MCL64 - Native BASIC CHRGET
+// ----------------------------------------------------------------------------
+// CHRGET ($0073) is the routine the KERNAL copies to zero page at reset.
+// It increments TXTPTR ($7A/$7B), which is the operand of its own LDA,
+// loads the character there, skips spaces and classifies it with two
+// compares and two subtracts.  The interpreter calls it, or its CHRGOT
+// entry ($0079) which reads the character again, for every token of every
+// statement.
+//
+// Both entries are trapped in RAM and run as one step on fp_chrget() and
+// fp_chrgot(), the translation FIN already uses (basic_convert.h).  The
+// zero page policy is kept by fp_begin() and fp_end(), and the text is
+// read with read_byte().  A, C, N, Z and V are left as the routine
+// leaves them:
+//  A  the character
+//  C  clear for a digit
+//  Z  set for ':' and the end of a line (0)
+//
+// The traps decline when the code at $0073-$008A is not the KERNAL's,
+// e.g. when a wedge has patched it, when the zero page is not held in
+// internal memory and in decimal mode.
+// ============================================================================
+
+#ifndef BASIC_CHRGET_H
+#define BASIC_CHRGET_H
+
+#if ENABLE_ACCELERATION
+
+// -------------------------------------------------
+// Trap handlers
+// -------------------------------------------------
+uint8_t native_chrget() {
+    if (!fp_chrget_canonical() || !fp_begin()) return NATIVE_DECLINE;
+    fp_chrget();
+    return fp_end();
+}
+
+uint8_t native_chrgot() {
+    if (!fp_chrget_canonical() || !fp_begin()) return NATIVE_DECLINE;
+    fp_chrgot();
+    return fp_end();
+}
+
+
+void basic_chrget_register_traps() {
+    native_trap_register(0x0073, NATIVE_TRAP_RAM, native_chrget);
+    native_trap_register(0x0079, NATIVE_TRAP_RAM, native_chrgot);
+    return;
+}
+
+#endif // ENABLE_ACCELERATION
+
+#endif // BASIC_CHRGET_H
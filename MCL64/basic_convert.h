@@ -0,0 +1,402 @@
+// ============================================================================
+// MCL64 - Native BASIC Number Conversion
+// ----------------------------------------------------------------------------
+// FIN parses a number from the text at TXTPTR ($7A/$7B) into FAC and FOUT
+// formats FAC as a string at $0100, so numeric literals, INPUT, VAL, PRINT
+// and STR$ all pass through them.  Both are translated from BASIC_ROM the
+// same way as basic_float.h and use its MUL10, DIV10, FCOMP and QINT, so
+// the float from FIN and the string from FOUT, with the leading sign
+// character, the trailing zeros removed and the E format outside
+// 0.01-999999999, are byte-identical to the ROM.
+//
+//  $BCF3 FIN    FAC = number at TXTPTR, entered with CHRGOT's A and C
+//  $BDDD FOUT   String at $0100 for FAC, A/Y = $0100 on return
+//  $BDDF        String at $00FF+Y, used by STR$ and line numbers
+//
+// FIN reads the text with CHRGET and declines when the CHRGET code at
+// $0073 is not the one the KERNAL copied there, e.g. when a wedge has
+// patched it.
+// ============================================================================
+
+#ifndef BASIC_CONVERT_H
+#define BASIC_CONVERT_H
+
+#if ENABLE_ACCELERATION
+
+#define CHRGET_ROM_OFFSET     0x03A2  // $E3A2 in KERNAL_ROM is copied to $0073-$008A
+
+
+// -------------------------------------------------
+// Is the CHRGET routine at $0073 the KERNAL's?
+//  TXTPTR at $7A/$7B is the operand of its LDA and not compared
+// -------------------------------------------------
+inline uint8_t fp_chrget_canonical() {
+    return (memcmp(&internal_RAM[0x73], &KERNAL_ROM[CHRGET_ROM_OFFSET],     7)==0 &&
+            memcmp(&internal_RAM[0x7C], &KERNAL_ROM[CHRGET_ROM_OFFSET+0x9], 15)==0);
+}
+
+
+// -------------------------------------------------
+// $0073 CHRGET - Next character of the text, skipping spaces
+//  $0079 CHRGOT classifies the character at TXTPTR again
+//  C is clear for a digit, Z set for ':' and the end of a line
+// -------------------------------------------------
+void fp_chrgot() {
+    while (1) {
+      fp_a = read_byte(ZP(0x7A) | (ZP(0x7B)<<8));
+      fp_cmp(fp_a, 0x3A);
+      if (fp_c) return;
+      fp_cmp(fp_a, 0x20);
+      if (fp_nz!=0) break;
+      fp_inc(0x7A);
+      if (fp_nz==0) fp_inc(0x7B);
+    }
+    fp_c = 0x1;
+    fp_sbc(0x30);
+    fp_c = 0x1;
+    fp_sbc(0xD0);
+    return;
+}
+
+void fp_chrget() {
+    fp_inc(0x7A);
+    if (fp_nz==0) fp_inc(0x7B);
+    fp_chrgot();
+    return;
+}
+
+
+// -------------------------------------------------
+// $BCF3 FIN - Parse a number
+//  $5D digits after the point, $5E exponent, $5F point seen, $60
+//  exponent sign and $67 sign of the number
+// -------------------------------------------------
+void fp_fin() {
+
+    fp_y = 0x0;
+    fp_x = 0x0A;
+    do {
+      ZP(0x5D+fp_x) = fp_y;
+      fp_nz = --fp_x;
+    } while ((fp_nz&0x80)==0);
+
+    if (fp_c==0) goto mantissa_digit;
+    fp_cmp(fp_a, 0x2D);
+    if (fp_nz==0) {
+      ZP(0x67) = fp_x;
+      goto next_character;
+    }
+    fp_cmp(fp_a, 0x2B);
+    if (fp_nz!=0) goto not_digit;
+
+next_character:                                                        // $BD0A
+    fp_chrget();
+    if (fp_c==0) goto mantissa_digit;
+
+not_digit:
+    fp_cmp(fp_a, 0x2E);
+    if (fp_nz==0) goto decimal_point;
+    fp_cmp(fp_a, 0x45);
+    if (fp_nz!=0) goto scale;
+
+    fp_chrget();                                                       // Exponent, '-' and '+' may be tokens
+    if (fp_c==0) goto exponent_digit;
+    fp_cmp(fp_a, 0xAB);  if (fp_nz==0) goto exponent_negative;
+    fp_cmp(fp_a, 0x2D);  if (fp_nz==0) goto exponent_negative;
+    fp_cmp(fp_a, 0xAA);  if (fp_nz==0) goto exponent_next;
+    fp_cmp(fp_a, 0x2B);  if (fp_nz==0) goto exponent_next;
+    goto exponent_end;
+
+exponent_negative:
+    fp_ror(0x60);
+exponent_next:                                                         // $BD30
+    fp_chrget();
+    if (fp_c==0) goto exponent_digit;
+exponent_end:
+    fp_bit(0x60);
+    if ((fp_nz&0x80)==0) goto scale;
+    fp_a = 0x0;
+    fp_c = 0x1;
+    fp_sbc(ZP(0x5E));
+    goto scale_a;
+
+decimal_point:
+    fp_ror(0x5F);
+    fp_bit(0x5F);
+    if (fp_v==0) goto next_character;
+
+scale:                                                                 // $BD47, exponent less the digits after the point
+    fp_nz = fp_a = ZP(0x5E);
+scale_a:
+    fp_c = 0x1;
+    fp_sbc(ZP(0x5D));
+    ZP(0x5E) = fp_a;
+    if (fp_nz!=0) {
+      if (fp_nz&0x80) {
+        do {
+          FP_JSR(0xBD54, fp_div10());
+          fp_inc(0x5E);
+        } while (fp_nz!=0);
+      }
+      else {
+        do {
+          FP_JSR(0xBD5D, fp_mul10());
+          fp_dec(0x5E);
+        } while (fp_nz!=0);
+      }
+    }
+    fp_nz = fp_a = ZP(0x67);
+    if (fp_a&0x80) fp_negop();
+    return;
+
+mantissa_digit:                                                        // $BD6A
+    fp_push(fp_a);
+    fp_bit(0x5F);
+    if (fp_nz&0x80) fp_inc(0x5D);
+    FP_JSR(0xBD73, fp_mul10());
+    fp_a = fp_pull();
+    fp_c = 0x1;
+    fp_sbc(0x30);
+    FP_JSR(0xBD7A, fp_add_signed_a());
+    goto next_character;
+
+exponent_digit:                                                        // $BD91
+    fp_nz = fp_a = ZP(0x5E);
+    fp_cmp(fp_a, 0x0A);
+    if (fp_c) {
+      fp_nz = fp_a = 0x64;                                             // More than two digits, 100 when negative
+      fp_bit(0x60);
+      if ((fp_nz&0x80)==0) {
+        fp_raise(FP_ERROR_OVERFLOW);
+        return;
+      }
+    }
+    else {
+      fp_asl_a();
+      fp_asl_a();
+      fp_c = 0x0;
+      fp_adc(ZP(0x5E));
+      fp_asl_a();
+      fp_c = 0x0;
+      fp_y = 0x0;
+      fp_adc(read_byte(ZP(0x7A) | (ZP(0x7B)<<8)));
+      fp_c = 0x1;
+      fp_sbc(0x30);
+    }
+    ZP(0x5E) = fp_a;
+    goto exponent_next;
+}
+
+
+// -------------------------------------------------
+// $BDDF FOUT - FAC as a string at $00FF+Y
+//  FAC is scaled by MUL10 and DIV10 to 99999999.9-999999999, then the
+//  nine digits are taken by adding powers of ten from the table at $BF16
+// -------------------------------------------------
+void fp_fout_y() {
+
+    fp_a = 0x20;
+    fp_bit(0x66);
+    if (fp_nz&0x80) fp_nz = fp_a = 0x2D;
+    write_byte(0x00FF+fp_y, fp_a);
+    ZP(0x66) = fp_a;
+    ZP(0x71) = fp_y;
+    fp_y++;
+    fp_a = 0x30;
+    fp_nz = fp_x = ZP(0x61);
+    if (fp_x==0) {
+      write_byte(0x00FF+fp_y, fp_a);
+      goto terminate;
+    }
+
+    fp_a = 0x0;
+    fp_cmp(fp_x, 0x80);
+    if (fp_nz==0 || fp_c==0) {                                         // Below 1, scale by 1E9 first
+      fp_a = 0xBD;
+      fp_y = 0xBD;
+      FP_JSR(0xBE06, fp_fmult());
+      fp_a = 0xF7;
+    }
+    ZP(0x5D) = fp_a;
+
+compare_high:                                                          // $BE0B
+    fp_a = 0xB8;
+    fp_y = 0xBD;
+    fp_fcomp();
+    if (fp_nz==0) goto rounded;
+    if ((fp_nz&0x80)==0) goto divide;
+compare_low:
+    fp_a = 0xB3;
+    fp_y = 0xBD;
+    fp_fcomp();
+    if (fp_nz!=0 && (fp_nz&0x80)==0) goto round_half;
+    FP_JSR(0xBE23, fp_mul10());
+    fp_dec(0x5D);
+    if (fp_nz!=0) goto compare_low;
+divide:
+    FP_JSR(0xBE2A, fp_div10());
+    fp_inc(0x5D);
+    if (fp_nz!=0) goto compare_high;
+round_half:
+    FP_JSR(0xBE31, fp_faddh());
+rounded:
+    fp_qint();
+
+    fp_x = 0x01;                                                       // Position of the point, or E format
+    fp_a = ZP(0x5D);
+    fp_c = 0x0;
+    fp_adc(0x0A);
+    if ((fp_nz&0x80)==0) {
+      fp_cmp(fp_a, 0x0B);
+      if (fp_c==0) {
+        fp_adc(0xFF);
+        fp_nz = fp_x = fp_a;
+        fp_a = 0x02;
+        fp_c = 0x1;
+      }
+    }
+    else fp_c = 0x1;
+    fp_sbc(0x02);
+    ZP(0x5E) = fp_a;
+    ZP(0x5D) = fp_x;
+    fp_nz = fp_a = fp_x;
+    if (fp_nz==0 || (fp_nz&0x80)) {
+      fp_y = ZP(0x71);
+      fp_a = 0x2E;
+      fp_y++;
+      write_byte(0x00FF+fp_y, fp_a);
+      fp_nz = fp_a = fp_x;
+      if (fp_a!=0) {
+        fp_a = 0x30;
+        fp_y++;
+        write_byte(0x00FF+fp_y, fp_a);
+      }
+      ZP(0x71) = fp_y;
+    }
+
+    fp_y = 0x0;
+    fp_x = 0x80;
+digit:                                                                 // $BE6A, add or subtract a power of ten until the sign flips
+    fp_a = ZP(0x65);  fp_c = 0x0;  fp_adc(read_byte(0xBF19+fp_y));  ZP(0x65) = fp_a;
+    fp_a = ZP(0x64);               fp_adc(read_byte(0xBF18+fp_y));  ZP(0x64) = fp_a;
+    fp_a = ZP(0x63);               fp_adc(read_byte(0xBF17+fp_y));  ZP(0x63) = fp_a;
+    fp_a = ZP(0x62);               fp_adc(read_byte(0xBF16+fp_y));  ZP(0x62) = fp_a;
+    fp_nz = ++fp_x;
+    if (fp_c) {
+      if (fp_nz&0x80) goto digit;
+    }
+    else {
+      if ((fp_nz&0x80)==0) goto digit;
+    }
+    fp_nz = fp_a = fp_x;
+    if (fp_c) {                                                        // Counted down, the digit is 10 - count
+      fp_a ^= 0xFF;
+      fp_adc(0x0A);
+    }
+    fp_adc(0x2F);
+    fp_y += 4;
+    ZP(0x47) = fp_y;
+    fp_y = ZP(0x71) + 1;
+    fp_x = fp_a;
+    fp_nz = fp_a &= 0x7F;
+    write_byte(0x00FF+fp_y, fp_a);
+    fp_dec(0x5D);
+    if (fp_nz==0) {
+      fp_a = 0x2E;
+      fp_y++;
+      write_byte(0x00FF+fp_y, fp_a);
+    }
+    ZP(0x71) = fp_y;
+    fp_y = ZP(0x47);
+    fp_nz = fp_x = fp_a = (fp_x ^ 0xFF) & 0x80;
+    fp_cmp(fp_y, 0x24);
+    if (fp_nz!=0) {
+      fp_cmp(fp_y, 0x3C);
+      if (fp_nz!=0) goto digit;
+    }
+
+    fp_y = ZP(0x71);                                                   // Remove trailing zeros and a trailing point
+    do {
+      fp_a = read_byte(0x00FF+fp_y);
+      fp_y--;
+      fp_cmp(fp_a, 0x30);
+    } while (fp_nz==0);
+    fp_cmp(fp_a, 0x2E);
+    if (fp_nz!=0) fp_y++;
+
+    fp_a = 0x2B;
+    fp_nz = fp_x = ZP(0x5E);
+    if (fp_x==0) goto terminate;
+    if (fp_x&0x80) {
+      fp_a = 0x0;
+      fp_c = 0x1;
+      fp_sbc(ZP(0x5E));
+      fp_x = fp_a;
+      fp_a = 0x2D;
+    }
+    write_byte(0x0101+fp_y, fp_a);
+    fp_a = 0x45;
+    write_byte(0x0100+fp_y, fp_a);
+    fp_nz = fp_a = fp_x;
+    fp_x = 0x2F;
+    fp_c = 0x1;
+    do {
+      fp_x++;
+      fp_sbc(0x0A);
+    } while (fp_c);
+    fp_adc(0x3A);
+    write_byte(0x0103+fp_y, fp_a);
+    fp_a = fp_x;
+    write_byte(0x0102+fp_y, fp_a);
+    fp_a = 0x0;
+    write_byte(0x0104+fp_y, fp_a);
+    goto finish;
+
+terminate:
+    fp_a = 0x0;
+    write_byte(0x0100+fp_y, fp_a);
+finish:
+    fp_a  = 0x0;
+    fp_nz = fp_y = 0x01;
+    return;
+}
+
+
+// -------------------------------------------------
+// Trap handlers
+// -------------------------------------------------
+uint8_t native_fin() {
+    if (!fp_begin() || !fp_chrget_canonical()) return NATIVE_DECLINE;
+    fp_fin();
+    return fp_end();
+}
+
+// An unnormalized FAC never reaches the digit range, leave that to the ROM
+inline uint8_t fp_fout_normalized() {
+    return (ZP(0x61)==0 || (ZP(0x62)&0x80));
+}
+
+uint8_t native_fout() {
+    if (!fp_fout_normalized() || !fp_begin()) return NATIVE_DECLINE;
+    fp_y = 0x01;
+    fp_fout_y();
+    return fp_end();
+}
+
+uint8_t native_fout_y() {
+    if (!fp_fout_normalized() || !fp_begin()) return NATIVE_DECLINE;
+    fp_fout_y();
+    return fp_end();
+}
+
+
+void basic_convert_register_traps() {
+    native_trap_register(0xBCF3, NATIVE_TRAP_BASIC, native_fin);
+    native_trap_register(0xBDDD, NATIVE_TRAP_BASIC, native_fout);
+    native_trap_register(0xBDDF, NATIVE_TRAP_BASIC, native_fout_y);
+    return;
+}
+
+#endif // ENABLE_ACCELERATION
+
+#endif // BASIC_CONVERT_H
@@ -0,0 +1,1154 @@
+// ============================================================================
+// MCL64 - Native BASIC Floating Point Arithmetic
+// ----------------------------------------------------------------------------
+// FADD, FSUB, FMULT and FDIV of BASIC_ROM are run as native traps on FAC
+// ($61-$66) and ARG ($69-$6E) in the zero page of internal_RAM.  Each
+// routine is translated instruction for instruction from the ROM, with the
+// 6502 registers and the N, V, Z and C flags kept in fp_a..fp_v, so the
+// rounding byte $70, ARISGN $6F, the partial products at $26-$2A, the
+// shift byte $56 and the registers and flags on return are the same as
+// the ROM leaves them.  Only the return addresses and status bytes the
+// ROM would have left on the stack page below SP are not written.
+//
+//  $B850 FSUB   $B853 FSUBT   FAC = (A,Y) - FAC     / ARG - FAC
+//  $B867 FADD   $B86A FADDT   FAC = (A,Y) + FAC     / ARG + FAC
+//  $BA28 FMULT  $BA2B FMULTT  FAC = (A,Y) * FAC     / ARG * FAC
+//  $BB0F FDIV   $BB12 FDIVT   FAC = (A,Y) / FAC     / ARG / FAC
+//
+// Overflow and division by zero leave the stack as the ROM would at that
+// point and continue at the BASIC error handler $A437 with the error
+// number in X.  The handlers decline in decimal mode and when the zero
+// page is not held in internal memory.
+// ============================================================================
+
+#ifndef BASIC_FLOAT_H
+#define BASIC_FLOAT_H
+
+#if ENABLE_ACCELERATION
+
+#define FP_ERROR_HANDLER      0xA437
+#define FP_ERROR_OVERFLOW     0x0F
+#define FP_ERROR_DIVIDE_ZERO  0x14
+
+#define FP_SHIFT_BYTES        0x0     // $B983 - Shift $26-$29 right a byte
+#define FP_SHIFT_ADD          0x1     // $B999 - Shift X+1..X+4 right by -A bits
+#define FP_SHIFT_ROR          0x2     // $B9B0 - Rotate X+2..X+4 and A, then continue with $B9A6
+
+#define FP_STACK_SIZE         32
+
+#define ZP(address)  internal_RAM[(address)&0xFF]
+
+uint8_t   fp_a, fp_x, fp_y;           // 6502 registers of the translated routine
+uint8_t   fp_c, fp_v;                 // Carry and overflow flags
+uint8_t   fp_nz;                      // Last result, for the N and Z flags
+uint8_t   fp_error=0;                 // BASIC error number, 0 = none
+uint8_t   fp_stack[FP_STACK_SIZE];    // Return addresses and bytes the ROM would have on the stack
+uint8_t   fp_stack_depth=0;
+
+
+// -------------------------------------------------
+// 6502 operations on the translated registers
+// -------------------------------------------------
+inline void fp_adc(uint8_t data) {
+  uint16_t sum = fp_a + data + fp_c;
+
+    fp_v  = ((~(fp_a^data) & (fp_a^sum) & 0x80)!=0);
+    fp_c  = sum >> 8;
+    fp_a  = sum;
+    fp_nz = fp_a;
+    return;
+}
+
+inline void fp_sbc(uint8_t data)  { fp_adc(~data); }
+
+inline void fp_cmp(uint8_t reg, uint8_t data) {
+    fp_c  = (reg>=data);
+    fp_nz = reg - data;
+    return;
+}
+
+inline void fp_asl(uint8_t address) {
+    fp_c  = ZP(address) >> 7;
+    fp_nz = ZP(address) = ZP(address) << 1;
+    return;
+}
+
+inline void fp_rol(uint8_t address) {
+  uint8_t carry = ZP(address) >> 7;
+
+    fp_nz = ZP(address) = (ZP(address) << 1) | fp_c;
+    fp_c  = carry;
+    return;
+}
+
+inline void fp_ror(uint8_t address) {
+  uint8_t carry = ZP(address) & 0x1;
+
+    fp_nz = ZP(address) = (ZP(address) >> 1) | (fp_c << 7);
+    fp_c  = carry;
+    return;
+}
+
+inline void fp_lsr(uint8_t address) {
+    fp_c  = ZP(address) & 0x1;
+    fp_nz = ZP(address) = ZP(address) >> 1;
+    return;
+}
+
+inline void fp_inc(uint8_t address) {
+    fp_nz = ++ZP(address);
+    return;
+}
+
+inline void fp_dec(uint8_t address) {
+    fp_nz = --ZP(address);
+    return;
+}
+
+// BIT keeps N from memory, Z is only right when N is clear
+inline void fp_bit(uint8_t address) {
+    fp_v  = (ZP(address)>>6) & 0x1;
+    fp_nz = (ZP(address)&0x80) | ((fp_a&ZP(address))!=0);
+    return;
+}
+
+inline void fp_ror_a() {
+  uint8_t carry = fp_a & 0x1;
+
+    fp_nz = fp_a = (fp_a >> 1) | (fp_c << 7);
+    fp_c  = carry;
+    return;
+}
+
+inline void fp_lsr_a() {
+    fp_c  = fp_a & 0x1;
+    fp_nz = fp_a = fp_a >> 1;
+    return;
+}
+
+inline void fp_asl_a() {
+    fp_c  = fp_a >> 7;
+    fp_nz = fp_a = fp_a << 1;
+    return;
+}
+
+inline void fp_rol_a() {
+  uint8_t carry = fp_a >> 7;
+
+    fp_nz = fp_a = (fp_a << 1) | fp_c;
+    fp_c  = carry;
+    return;
+}
+
+
+// -------------------------------------------------
+// Errors jump to the BASIC error handler with the ROM's stack
+// -------------------------------------------------
+void fp_raise(uint8_t error) {
+  uint8_t i;
+
+    for (i=0; i<fp_stack_depth; i++) push(fp_stack[i]);
+    fp_x  = error;
+    fp_nz = error;
+    fp_error = error;
+    return;
+}
+
+inline void    fp_push(uint8_t data)   { fp_stack[fp_stack_depth++] = data; }
+inline uint8_t fp_pull()               { return fp_stack[--fp_stack_depth]; }
+
+// JSR and RTS of a routine that may raise an error
+inline void fp_call(uint16_t return_address) {
+    fp_push(return_address >> 8);
+    fp_push(return_address);
+    return;
+}
+
+inline void fp_return()  { fp_stack_depth -= 2; }
+
+#define FP_JSR(return_address, routine)  { fp_call(return_address);  routine;  fp_return();  if (fp_error) return; }
+
+
+// -------------------------------------------------
+// $BA8C CONUPK - Load ARG from the float at (A,Y)
+// -------------------------------------------------
+void fp_conupk() {
+  uint16_t address;
+
+    ZP(0x22) = fp_a;
+    ZP(0x23) = fp_y;
+    address  = fp_a | (fp_y<<8);
+
+    ZP(0x6D) = read_byte(address+4);
+    ZP(0x6C) = read_byte(address+3);
+    ZP(0x6B) = read_byte(address+2);
+    ZP(0x6E) = read_byte(address+1);
+    ZP(0x6F) = ZP(0x6E) ^ ZP(0x66);
+    ZP(0x6A) = ZP(0x6E) | 0x80;
+    ZP(0x69) = read_byte(address);
+    fp_y  = 0x0;
+    fp_nz = fp_a = ZP(0x61);
+    return;
+}
+
+
+// -------------------------------------------------
+// $BBFC MOVFA - Copy ARG to FAC
+//  $BBFE takes the sign for FAC from A
+// -------------------------------------------------
+void fp_movfa_sign() {
+    ZP(0x66) = fp_a;
+    for (fp_x=5; fp_x!=0; fp_x--) {
+      fp_a = ZP(0x68+fp_x);
+      ZP(0x60+fp_x) = fp_a;
+    }
+    fp_nz = 0x0;
+    ZP(0x70) = 0x0;
+    return;
+}
+
+void fp_movfa() {
+    fp_a = ZP(0x6E);
+    fp_movfa_sign();
+    return;
+}
+
+
+// -------------------------------------------------
+// $B8F7 - Set FAC to zero
+// -------------------------------------------------
+void fp_zero() {
+    fp_nz = fp_a = 0x0;
+    ZP(0x61) = 0x0;
+    ZP(0x66) = 0x0;
+    return;
+}
+
+
+// -------------------------------------------------
+// $B96F - Add one to the FAC mantissa
+// -------------------------------------------------
+void fp_increment_mantissa() {
+    fp_inc(0x65);  if (fp_nz!=0) return;
+    fp_inc(0x64);  if (fp_nz!=0) return;
+    fp_inc(0x63);  if (fp_nz!=0) return;
+    fp_inc(0x62);
+    return;
+}
+
+
+// -------------------------------------------------
+// $B947 - Negate FAC, $B94D - two's complement of the mantissa and
+// rounding byte only
+// -------------------------------------------------
+void fp_negate_mantissa() {
+  uint8_t address;
+
+    for (address=0x62; address<=0x65; address++) {
+      fp_a = ZP(address) ^ 0xFF;
+      ZP(address) = fp_a;
+    }
+    fp_a = ZP(0x70) ^ 0xFF;
+    ZP(0x70) = fp_a;
+    fp_inc(0x70);
+    if (fp_nz==0) fp_increment_mantissa();
+    return;
+}
+
+void fp_negate() {
+    fp_a = ZP(0x66) ^ 0xFF;
+    ZP(0x66) = fp_a;
+    fp_negate_mantissa();
+    return;
+}
+
+
+// -------------------------------------------------
+// $B938 - Mantissa carried out, shift it back and bump the exponent
+// -------------------------------------------------
+void fp_carry_exponent() {
+    fp_inc(0x61);
+    if (fp_nz==0) {
+      fp_raise(FP_ERROR_OVERFLOW);
+      return;
+    }
+    fp_ror(0x62);
+    fp_ror(0x63);
+    fp_ror(0x64);
+    fp_ror(0x65);
+    fp_ror(0x70);
+    return;
+}
+
+
+// -------------------------------------------------
+// $B8D7 NORMAL - Normalize FAC
+// -------------------------------------------------
+void fp_normalize() {
+
+    fp_y = 0x0;
+    fp_a = 0x0;
+    fp_c = 0x0;
+
+byte_shift:
+    fp_nz = fp_x = ZP(0x62);
+    if (fp_x!=0) goto bit_shift;
+    ZP(0x62) = fp_x = ZP(0x63);
+    ZP(0x63) = fp_x = ZP(0x64);
+    ZP(0x64) = fp_x = ZP(0x65);
+    ZP(0x65) = fp_x = ZP(0x70);
+    ZP(0x70) = fp_y;
+    fp_adc(0x08);
+    fp_cmp(fp_a, 0x20);
+    if (fp_nz!=0) goto byte_shift;
+    fp_zero();
+    return;
+
+bit_loop:
+    fp_adc(0x01);
+    fp_asl(0x70);
+    fp_rol(0x65);
+    fp_rol(0x64);
+    fp_rol(0x63);
+    fp_rol(0x62);
+bit_shift:
+    if ((fp_nz&0x80)==0) goto bit_loop;
+
+    fp_c = 0x1;
+    fp_sbc(ZP(0x61));
+    if (fp_c) {                                                        // Underflow
+      fp_zero();
+      return;
+    }
+    fp_a ^= 0xFF;
+    fp_adc(0x01);
+    ZP(0x61) = fp_a;
+
+    if (fp_c) fp_carry_exponent();                                     // $B936
+    return;
+}
+
+
+// -------------------------------------------------
+// $B983, $B999, $B9B0 - Shift a mantissa right
+//  X points one below the mantissa, A is minus the shift count
+// -------------------------------------------------
+void fp_shift_right(uint8_t entry) {
+
+    if (entry==FP_SHIFT_ADD) goto add_eight;
+    if (entry==FP_SHIFT_ROR) goto rotate;
+    fp_x = 0x25;
+
+shift_byte:
+    ZP(0x70)   = fp_y = ZP(fp_x+4);
+    ZP(fp_x+4) = fp_y = ZP(fp_x+3);
+    ZP(fp_x+3) = fp_y = ZP(fp_x+2);
+    ZP(fp_x+2) = fp_y = ZP(fp_x+1);
+    ZP(fp_x+1) = fp_y = ZP(0x68);
+    fp_nz = fp_y;
+
+add_eight:
+    fp_adc(0x08);
+    if ((fp_nz&0x80) || fp_nz==0) goto shift_byte;
+    fp_sbc(0x08);
+    fp_nz = fp_y = fp_a;
+    fp_nz = fp_a = ZP(0x70);
+    if (fp_c) goto done;
+
+shift_bit:
+    fp_asl(fp_x+1);
+    if (fp_c) fp_inc(fp_x+1);
+    fp_ror(fp_x+1);
+    fp_ror(fp_x+1);
+rotate:
+    fp_ror(fp_x+2);
+    fp_ror(fp_x+3);
+    fp_ror(fp_x+4);
+    fp_ror_a();
+    fp_nz = ++fp_y;
+    if (fp_y!=0) goto shift_bit;
+
+done:
+    fp_c = 0x0;
+    return;
+}
+
+
+// -------------------------------------------------
+// $B86A FADDT - FAC = ARG + FAC
+//  zero is the Z flag on entry, set when FAC is zero.  $B877 adds ARG
+//  with the exponent in A, MUL10 enters there with FAC * 4 in ARG
+// -------------------------------------------------
+void fp_add_exponent_a() {
+
+    fp_nz = fp_y = fp_a;
+    if (fp_y==0) return;                                               // ARG is zero
+
+    fp_c = 0x1;
+    fp_sbc(ZP(0x61));
+    if (fp_nz==0) goto add_or_subtract;
+    if (fp_c) {                                                        // ARG is larger, shift FAC
+      ZP(0x61) = fp_y;
+      ZP(0x66) = fp_y = ZP(0x6E);
+      fp_a ^= 0xFF;
+      fp_adc(0x00);
+      ZP(0x56) = fp_y = 0x0;
+      fp_nz = fp_x = 0x61;
+    }
+    else {
+      ZP(0x70) = fp_y = 0x0;
+    }
+
+    fp_cmp(fp_a, 0xF9);
+    if (fp_nz&0x80) {
+      fp_shift_right(FP_SHIFT_ADD);
+    }
+    else {
+      fp_nz = fp_y = fp_a;
+      fp_nz = fp_a = ZP(0x70);
+      fp_lsr(fp_x+1);
+      fp_shift_right(FP_SHIFT_ROR);
+    }
+
+add_or_subtract:
+    fp_v = (ZP(0x6F)>>6) & 0x1;                                        // BIT $6F
+    if ((ZP(0x6F)&0x80)==0) {
+      fp_adc(ZP(0x56));
+      ZP(0x70) = fp_a;
+      fp_a = ZP(0x65);  fp_adc(ZP(0x6D));  ZP(0x65) = fp_a;
+      fp_a = ZP(0x64);  fp_adc(ZP(0x6C));  ZP(0x64) = fp_a;
+      fp_a = ZP(0x63);  fp_adc(ZP(0x6B));  ZP(0x63) = fp_a;
+      fp_a = ZP(0x62);  fp_adc(ZP(0x6A));  ZP(0x62) = fp_a;
+      if (fp_c) fp_carry_exponent();
+      return;
+    }
+
+    fp_y = 0x61;                                                       // Subtract the shifted operand from the other
+    fp_cmp(fp_x, 0x69);
+    if (fp_nz!=0) fp_y = 0x69;
+    fp_c = 0x1;
+    fp_a ^= 0xFF;
+    fp_adc(ZP(0x56));
+    ZP(0x70) = fp_a;
+    fp_a = ZP(fp_y+4);  fp_sbc(ZP(fp_x+4));  ZP(0x65) = fp_a;
+    fp_a = ZP(fp_y+3);  fp_sbc(ZP(fp_x+3));  ZP(0x64) = fp_a;
+    fp_a = ZP(fp_y+2);  fp_sbc(ZP(fp_x+2));  ZP(0x63) = fp_a;
+    fp_a = ZP(fp_y+1);  fp_sbc(ZP(fp_x+1));  ZP(0x62) = fp_a;
+    if (fp_c==0) fp_negate();
+    fp_normalize();
+    return;
+}
+
+void fp_faddt(uint8_t zero) {
+
+    if (zero) {
+      fp_movfa();
+      return;
+    }
+
+    ZP(0x56) = fp_x = ZP(0x70);
+    fp_x = 0x69;
+    fp_a = ZP(0x69);
+    fp_add_exponent_a();
+    return;
+}
+
+
+// -------------------------------------------------
+// $B853 FSUBT - FAC = ARG - FAC
+// -------------------------------------------------
+void fp_fsubt() {
+    fp_a = ZP(0x66) ^ 0xFF;
+    ZP(0x66) = fp_a;
+    fp_a ^= ZP(0x6E);
+    ZP(0x6F) = fp_a;
+    fp_nz = fp_a = ZP(0x61);
+    fp_faddt(fp_a==0);
+    return;
+}
+
+
+// -------------------------------------------------
+// $BC1B ROUND - Round FAC using the rounding byte
+//  $BC23 adds one to the mantissa unconditionally
+// -------------------------------------------------
+void fp_round_up() {
+    fp_increment_mantissa();
+    if (fp_nz==0) fp_carry_exponent();
+    return;
+}
+
+void fp_round() {
+    fp_nz = fp_a = ZP(0x61);
+    if (fp_a==0) return;
+    fp_asl(0x70);
+    if (fp_c==0) return;
+    fp_round_up();
+    return;
+}
+
+
+// -------------------------------------------------
+// $BAB7 MULDIV - Exponent and sign of a product or quotient
+//  $BAB9 is entered with the ARG exponent already in A
+//  Return: 1 when FAC was zeroed and the calling routine is complete
+// -------------------------------------------------
+uint8_t fp_muldiv_a() {
+
+    if (fp_nz==0) goto zero;
+    fp_c = 0x0;
+    fp_adc(ZP(0x61));
+    if (fp_c==0) {
+      if ((fp_nz&0x80)==0) goto zero;                                  // Underflow
+    }
+    else {
+      if (fp_nz&0x80) {
+        fp_raise(FP_ERROR_OVERFLOW);
+        return 1;
+      }
+      fp_c = 0x0;                                                      // BIT $1410 skips the BPL, its flags are overwritten
+    }
+    fp_adc(0x80);
+    ZP(0x61) = fp_a;
+    if (fp_nz==0) {
+      ZP(0x66) = fp_a;
+      return 0;
+    }
+    fp_nz = fp_a = ZP(0x6F);                                           // LDA $6F, the flags are returned
+    ZP(0x66) = fp_a;
+    return 0;
+
+zero:
+    fp_zero();                                                         // PLA PLA, JMP $B8F7
+    return 1;
+}
+
+uint8_t fp_muldiv() {
+    fp_nz = fp_a = ZP(0x69);
+    return fp_muldiv_a();
+}
+
+
+// -------------------------------------------------
+// $BAD4 - Result out of range, overflow when FAC is positive and zero
+// when negative.  Either way the calling routine is complete.
+// -------------------------------------------------
+void fp_out_of_range() {
+    fp_nz = fp_a = ZP(0x66) ^ 0xFF;
+    if (fp_nz&0x80) fp_raise(FP_ERROR_OVERFLOW);
+    else            fp_zero();
+    return;
+}
+
+
+// -------------------------------------------------
+// $BB8F - Move the result at $26-$29 to FAC and normalize
+// -------------------------------------------------
+void fp_move_result() {
+    ZP(0x62) = ZP(0x26);
+    ZP(0x63) = ZP(0x27);
+    ZP(0x64) = ZP(0x28);
+    fp_a = ZP(0x65) = ZP(0x29);
+    fp_normalize();
+    return;
+}
+
+
+// -------------------------------------------------
+// $BA59 - Multiply ARG by one byte of FAC into $26-$29
+//  The top byte enters at $BA5E, past the test for zero
+// -------------------------------------------------
+void fp_multiply_byte(uint8_t byte, uint8_t test_zero) {
+
+    fp_nz = fp_a = byte;
+    if (test_zero && fp_a==0) {
+      fp_shift_right(FP_SHIFT_BYTES);
+      return;
+    }
+    fp_lsr_a();
+    fp_a |= 0x80;
+
+    do {
+      fp_y = fp_a;
+      if (fp_c) {
+        fp_c = 0x0;
+        fp_a = ZP(0x29);  fp_adc(ZP(0x6D));  ZP(0x29) = fp_a;
+        fp_a = ZP(0x28);  fp_adc(ZP(0x6C));  ZP(0x28) = fp_a;
+        fp_a = ZP(0x27);  fp_adc(ZP(0x6B));  ZP(0x27) = fp_a;
+        fp_a = ZP(0x26);  fp_adc(ZP(0x6A));  ZP(0x26) = fp_a;
+      }
+      fp_ror(0x26);
+      fp_ror(0x27);
+      fp_ror(0x28);
+      fp_ror(0x29);
+      fp_ror(0x70);
+      fp_a = fp_y;
+      fp_lsr_a();
+    } while (fp_a!=0);
+    return;
+}
+
+
+// -------------------------------------------------
+// $BA2B FMULTT - FAC = ARG * FAC
+// -------------------------------------------------
+void fp_fmultt(uint8_t zero) {
+  uint8_t complete;
+
+    if (zero) return;
+
+    fp_call(0xBA32);
+    complete = fp_muldiv();
+    fp_return();
+    if (complete) return;
+
+    fp_a = 0x0;
+    ZP(0x26) = 0x0;
+    ZP(0x27) = 0x0;
+    ZP(0x28) = 0x0;
+    ZP(0x29) = 0x0;
+    fp_multiply_byte(ZP(0x70), 1);
+    fp_multiply_byte(ZP(0x65), 1);
+    fp_multiply_byte(ZP(0x64), 1);
+    fp_multiply_byte(ZP(0x63), 1);
+    fp_multiply_byte(ZP(0x62), 0);
+    fp_move_result();
+    return;
+}
+
+
+// -------------------------------------------------
+// $BB12 FDIVT - FAC = ARG / FAC
+// -------------------------------------------------
+void fp_fdivt(uint8_t zero) {
+  uint8_t complete;
+  uint8_t saved_nz, saved_c, saved_v;
+
+    if (zero) {
+      fp_raise(FP_ERROR_DIVIDE_ZERO);
+      return;
+    }
+
+    fp_call(0xBB16);
+    fp_round();
+    fp_return();
+    if (fp_error) return;
+
+    fp_a = 0x0;
+    fp_c = 0x1;
+    fp_sbc(ZP(0x61));
+    ZP(0x61) = fp_a;
+
+    fp_call(0xBB20);
+    complete = fp_muldiv();
+    fp_return();
+    if (complete) return;
+
+    fp_inc(0x61);
+    if (fp_nz==0) {
+      fp_raise(FP_ERROR_OVERFLOW);
+      return;
+    }
+
+    fp_x = 0xFC;
+    fp_a = 0x01;
+
+compare:
+    fp_y = ZP(0x6A);  fp_cmp(fp_y, ZP(0x62));  if (fp_nz!=0) goto quotient_bit;
+    fp_y = ZP(0x6B);  fp_cmp(fp_y, ZP(0x63));  if (fp_nz!=0) goto quotient_bit;
+    fp_y = ZP(0x6C);  fp_cmp(fp_y, ZP(0x64));  if (fp_nz!=0) goto quotient_bit;
+    fp_y = ZP(0x6D);  fp_cmp(fp_y, ZP(0x65));
+
+quotient_bit:
+    saved_nz = fp_nz;                                                  // PHP
+    saved_c  = fp_c;
+    saved_v  = fp_v;
+    fp_rol_a();
+    if (fp_c==0) goto restore_flags;
+    fp_nz = ++fp_x;
+    ZP(0x29+fp_x) = fp_a;
+    if (fp_x==0) {
+      fp_nz = fp_a = 0x40;
+      goto restore_flags;
+    }
+    if ((fp_x&0x80)==0) goto rounding_bits;
+    fp_nz = fp_a = 0x01;
+
+restore_flags:
+    fp_nz = saved_nz;                                                  // PLP
+    fp_c  = saved_c;
+    fp_v  = saved_v;
+    if (fp_c) {
+      fp_y = fp_a;                                                     // Subtract FAC from ARG
+      fp_a = ZP(0x6D);  fp_sbc(ZP(0x65));  ZP(0x6D) = fp_a;
+      fp_a = ZP(0x6C);  fp_sbc(ZP(0x64));  ZP(0x6C) = fp_a;
+      fp_a = ZP(0x6B);  fp_sbc(ZP(0x63));  ZP(0x6B) = fp_a;
+      fp_a = ZP(0x6A);  fp_sbc(ZP(0x62));  ZP(0x6A) = fp_a;
+      fp_nz = fp_a = fp_y;
+    }
+
+    fp_asl(0x6D);
+    fp_rol(0x6C);
+    fp_rol(0x6B);
+    fp_rol(0x6A);
+    if (fp_c) goto quotient_bit;
+    if (fp_nz&0x80) goto compare;
+    goto quotient_bit;
+
+rounding_bits:
+    fp_asl_a();  fp_asl_a();  fp_asl_a();
+    fp_asl_a();  fp_asl_a();  fp_asl_a();
+    ZP(0x70) = fp_a;
+    fp_nz = saved_nz;                                                  // PLP
+    fp_c  = saved_c;
+    fp_v  = saved_v;
+    fp_move_result();
+    return;
+}
+
+
+// -------------------------------------------------
+// Memory entries, ARG is loaded from (A,Y) by CONUPK
+// -------------------------------------------------
+void fp_fsub()   { fp_conupk();  fp_fsubt();            return; }
+void fp_fadd()   { fp_conupk();  fp_faddt(fp_nz==0);    return; }
+void fp_fmult()  { fp_conupk();  fp_fmultt(fp_nz==0);   return; }
+void fp_fdiv()   { fp_conupk();  fp_fdivt(fp_nz==0);    return; }
+
+// $B849 FADDH - FAC = FAC + 0.5
+void fp_faddh() {
+    fp_a = 0x11;
+    fp_y = 0xBF;
+    fp_fadd();
+    return;
+}
+
+
+// -------------------------------------------------
+// $B8D2 - Negate FAC when C is clear, then normalize
+// -------------------------------------------------
+void fp_normalize_signed() {
+    if (fp_c==0) fp_negate();
+    fp_normalize();
+    return;
+}
+
+
+// -------------------------------------------------
+// $BBA2 MOVFM - Load FAC from the float at (A,Y)
+// -------------------------------------------------
+void fp_movfm() {
+  uint16_t address;
+
+    ZP(0x22) = fp_a;
+    ZP(0x23) = fp_y;
+    address  = fp_a | (fp_y<<8);
+
+    ZP(0x65) = read_byte(address+4);
+    ZP(0x64) = read_byte(address+3);
+    ZP(0x63) = read_byte(address+2);
+    fp_a = read_byte(address+1);
+    ZP(0x66) = fp_a;
+    ZP(0x62) = fp_a | 0x80;
+    fp_nz = fp_a = read_byte(address);
+    ZP(0x61) = fp_a;
+    fp_y = 0x0;
+    ZP(0x70) = 0x0;
+    return;
+}
+
+
+// -------------------------------------------------
+// $BBD4 MOVMF - Round FAC and store it at (X,Y)
+//  $BBCA stores to $57, $BBC7 to $5C and $BBD0 to the address at $49
+// -------------------------------------------------
+void fp_movmf() {
+  uint16_t address;
+
+    FP_JSR(0xBBD6, fp_round());
+
+    ZP(0x22) = fp_x;
+    ZP(0x23) = fp_y;
+    address  = fp_x | (fp_y<<8);
+
+    fp_y = 4;  fp_a = ZP(0x65);                       write_byte(address+4, fp_a);
+    fp_y = 3;  fp_a = ZP(0x64);                       write_byte(address+3, fp_a);
+    fp_y = 2;  fp_a = ZP(0x63);                       write_byte(address+2, fp_a);
+    fp_y = 1;  fp_a = (ZP(0x66) | 0x7F) & ZP(0x62);   write_byte(address+1, fp_a);
+    fp_y = 0;  fp_nz = fp_a = ZP(0x61);               write_byte(address, fp_a);
+    ZP(0x70) = fp_y;
+    return;
+}
+
+void fp_movmf_57() {
+    fp_x  = 0x57;
+    fp_nz = fp_y = 0x0;
+    fp_movmf();
+    return;
+}
+
+void fp_movmf_5c() {
+    fp_x  = 0x5C;
+    fp_v  = (read_byte(0x57A2)>>6) & 0x1;                              // BIT $57A2 hides the LDX #$57
+    fp_nz = fp_y = 0x0;
+    fp_movmf();
+    return;
+}
+
+void fp_movmf_forpnt() {
+    fp_x  = ZP(0x49);
+    fp_nz = fp_y = ZP(0x4A);
+    fp_movmf();
+    return;
+}
+
+
+// -------------------------------------------------
+// $BC0C MOVAF - Round FAC and copy it to ARG
+//  $BC0F copies without rounding
+// -------------------------------------------------
+void fp_movaf_unrounded() {
+    for (fp_x=6; fp_x!=0; fp_x--) {
+      fp_a = ZP(0x60+fp_x);
+      ZP(0x68+fp_x) = fp_a;
+    }
+    fp_nz = 0x0;
+    ZP(0x70) = 0x0;
+    return;
+}
+
+void fp_movaf() {
+    FP_JSR(0xBC0E, fp_round());
+    fp_movaf_unrounded();
+    return;
+}
+
+
+// -------------------------------------------------
+// $BC2B SIGN - A = 0, 1 or $FF for FAC zero, positive or negative
+//  $BC31 returns the sign of bit 7 of A
+// -------------------------------------------------
+void fp_sign_of_a() {
+    fp_rol_a();
+    fp_nz = fp_a = 0xFF;
+    if (fp_c) return;
+    fp_nz = fp_a = 0x01;
+    return;
+}
+
+void fp_sign() {
+    fp_nz = fp_a = ZP(0x61);
+    if (fp_a==0) return;
+    fp_a = ZP(0x66);
+    fp_sign_of_a();
+    return;
+}
+
+
+// -------------------------------------------------
+// $BC5B FCOMP - Compare FAC with the float at (A,Y)
+//  A = 0 when equal, 1 when FAC is smaller, $FF when larger
+// -------------------------------------------------
+void fp_fcomp() {
+  uint16_t address;
+
+    ZP(0x24) = fp_a;
+    ZP(0x25) = fp_y;
+    address  = fp_a | (fp_y<<8);
+
+    fp_a  = read_byte(address);
+    fp_y  = 1;
+    fp_nz = fp_x = fp_a;
+    if (fp_x==0) {
+      fp_sign();
+      return;
+    }
+    fp_nz = fp_a = read_byte(address+1) ^ ZP(0x66);
+    if (fp_nz&0x80) {                                                  // Signs differ
+      fp_a = ZP(0x66);
+      fp_sign_of_a();
+      return;
+    }
+    fp_cmp(fp_x, ZP(0x61));                                            if (fp_nz!=0) goto differ;
+    fp_a = read_byte(address+1) | 0x80;      fp_cmp(fp_a, ZP(0x62));   if (fp_nz!=0) goto differ;
+    fp_y = 2;  fp_a = read_byte(address+2);  fp_cmp(fp_a, ZP(0x63));   if (fp_nz!=0) goto differ;
+    fp_y = 3;  fp_a = read_byte(address+3);  fp_cmp(fp_a, ZP(0x64));   if (fp_nz!=0) goto differ;
+    fp_y = 4;
+    fp_a = 0x7F;
+    fp_cmp(fp_a, ZP(0x70));                                            // Rounding byte sets the borrow
+    fp_a = read_byte(address+4);
+    fp_sbc(ZP(0x65));
+    if (fp_nz==0) return;
+
+differ:
+    fp_a = ZP(0x66);
+    if (fp_c) fp_a ^= 0xFF;
+    fp_sign_of_a();
+    return;
+}
+
+
+// -------------------------------------------------
+// $BC9B QINT - FAC to a 32-bit integer in $62-$65
+// -------------------------------------------------
+void fp_qint() {
+
+    fp_nz = fp_a = ZP(0x61);
+    if (fp_a==0) {
+      ZP(0x62) = fp_a;
+      ZP(0x63) = fp_a;
+      ZP(0x64) = fp_a;
+      ZP(0x65) = fp_a;
+      fp_nz = fp_y = fp_a;
+      return;
+    }
+
+    fp_c = 0x1;
+    fp_sbc(0xA0);
+    fp_v = (ZP(0x66)>>6) & 0x1;                                        // BIT $66
+    if (ZP(0x66)&0x80) {
+      fp_x = fp_a;
+      fp_a = 0xFF;
+      ZP(0x68) = fp_a;
+      fp_negate_mantissa();
+      fp_a = fp_x;
+    }
+    fp_x = 0x61;
+    fp_cmp(fp_a, 0xF9);
+    if (fp_nz&0x80) {
+      fp_shift_right(FP_SHIFT_ADD);
+    }
+    else {
+      fp_y = fp_a;
+      fp_a = ZP(0x66) & 0x80;
+      fp_lsr(0x62);
+      fp_nz = fp_a |= ZP(0x62);
+      ZP(0x62) = fp_a;
+      fp_shift_right(FP_SHIFT_ROR);
+    }
+    ZP(0x68) = fp_y;
+    return;
+}
+
+
+// -------------------------------------------------
+// $BCCC INT - Truncate FAC towards minus infinity
+// -------------------------------------------------
+void fp_int() {
+
+    fp_nz = fp_a = ZP(0x61);
+    fp_cmp(fp_a, 0xA0);
+    if (fp_c) return;                                                  // Already an integer
+
+    fp_qint();
+    ZP(0x70) = fp_y;
+    fp_a = ZP(0x66);
+    ZP(0x66) = fp_y;
+    fp_a ^= 0x80;
+    fp_rol_a();
+    fp_a = 0xA0;
+    ZP(0x61) = fp_a;
+    fp_nz = fp_a = ZP(0x65);
+    ZP(0x07) = fp_a;
+    fp_normalize_signed();
+    return;
+}
+
+
+// -------------------------------------------------
+// $BC3C - FAC = signed byte in A
+// -------------------------------------------------
+void fp_float_a() {
+    ZP(0x62) = fp_a;
+    fp_a = 0x0;
+    ZP(0x63) = fp_a;
+    fp_x = 0x88;
+    fp_a = ZP(0x62) ^ 0xFF;
+    fp_rol_a();
+    fp_nz = fp_a = 0x0;
+    ZP(0x65) = fp_a;
+    ZP(0x64) = fp_a;
+    ZP(0x61) = fp_x;
+    ZP(0x70) = fp_a;
+    ZP(0x66) = fp_a;
+    fp_normalize_signed();
+    return;
+}
+
+
+// -------------------------------------------------
+// $BFB4 NEGOP - Negate FAC unless it is zero
+// -------------------------------------------------
+void fp_negop() {
+    fp_nz = fp_a = ZP(0x61);
+    if (fp_a==0) return;
+    fp_nz = fp_a = ZP(0x66) ^ 0xFF;
+    ZP(0x66) = fp_a;
+    return;
+}
+
+
+// -------------------------------------------------
+// $BD7E - FAC = FAC + the signed byte in A
+// -------------------------------------------------
+void fp_add_signed_a() {
+    fp_push(fp_a);
+    FP_JSR(0xBD81, fp_movaf());
+    fp_nz = fp_a = fp_pull();
+    FP_JSR(0xBD85, fp_float_a());
+    fp_a = ZP(0x6E) ^ ZP(0x66);
+    ZP(0x6F) = fp_a;
+    fp_nz = fp_x = ZP(0x61);
+    fp_faddt(fp_x==0);
+    return;
+}
+
+
+// -------------------------------------------------
+// $BB07 - FAC = (A,Y) / FAC with ARISGN in X
+// -------------------------------------------------
+void fp_fdiv_into() {
+    ZP(0x6F) = fp_x;
+    fp_movfm();
+    fp_fdivt(fp_nz==0);
+    return;
+}
+
+
+// -------------------------------------------------
+// $BAE2 MUL10 and $BAFE DIV10 - FAC = FAC * 10 and FAC / 10
+// -------------------------------------------------
+void fp_mul10() {
+    FP_JSR(0xBAE4, fp_movaf());
+    fp_nz = fp_x = fp_a;
+    if (fp_x==0) return;
+    fp_c = 0x0;
+    fp_adc(0x02);                                                      // ARG = FAC * 4
+    if (fp_c) {
+      fp_raise(FP_ERROR_OVERFLOW);
+      return;
+    }
+    fp_nz = fp_x = 0x0;
+    ZP(0x6F) = fp_x;
+    FP_JSR(0xBAF3, fp_add_exponent_a());
+    fp_inc(0x61);
+    if (fp_nz==0) fp_raise(FP_ERROR_OVERFLOW);
+    return;
+}
+
+void fp_div10() {
+    FP_JSR(0xBB00, fp_movaf());
+    fp_a  = 0xF9;
+    fp_y  = 0xBA;
+    fp_nz = fp_x = 0x0;
+    fp_fdiv_into();
+    return;
+}
+
+
+// -------------------------------------------------
+// Handler entry and exit
+// -------------------------------------------------
+uint8_t fp_begin() {
+
+    if ((register_flags&0x08) || !native_zero_page_begin()) return 0; // Decimal mode would change ADC and SBC
+
+    fp_a  = register_a;
+    fp_x  = register_x;
+    fp_y  = register_y;
+    fp_c  = register_flags & 0x01;
+    fp_v  = (register_flags>>6) & 0x1;
+    fp_nz = (register_flags&0x02) ? 0x00 : ((register_flags&0x80) | 0x01);
+    fp_error = 0;
+    fp_stack_depth = 0;
+    return 1;
+}
+
+uint8_t fp_end() {
+
+    register_a = fp_a;
+    register_x = fp_x;
+    register_y = fp_y;
+    register_flags = (register_flags & 0x3C) | (fp_nz & 0x80) | (fp_v<<6) | ((fp_nz==0) ? 0x02 : 0x00) | fp_c;
+    native_zero_page_end();
+
+    if (fp_error!=0) {
+      register_pc = FP_ERROR_HANDLER;
+      return NATIVE_JUMP;
+    }
+    return NATIVE_RTS;
+}
+
+inline uint8_t fp_entry_zero()  { return (register_flags&0x02)!=0; }
+
+
+// -------------------------------------------------
+// Trap handlers
+//  The memory entries load ARG with CONUPK first, the T entries take
+//  the Z flag their caller left from loading the FAC exponent
+// -------------------------------------------------
+uint8_t native_fsub() {
+    if (!fp_begin()) return NATIVE_DECLINE;
+    fp_fsub();
+    return fp_end();
+}
+
+uint8_t native_fsubt() {
+    if (!fp_begin()) return NATIVE_DECLINE;
+    fp_fsubt();
+    return fp_end();
+}
+
+uint8_t native_fadd() {
+    if (!fp_begin()) return NATIVE_DECLINE;
+    fp_fadd();
+    return fp_end();
+}
+
+uint8_t native_faddt() {
+    if (!fp_begin()) return NATIVE_DECLINE;
+    fp_faddt(fp_entry_zero());
+    return fp_end();
+}
+
+uint8_t native_fmult() {
+    if (!fp_begin()) return NATIVE_DECLINE;
+    fp_fmult();
+    return fp_end();
+}
+
+uint8_t native_fmultt() {
+    if (fp_entry_zero()) return NATIVE_RTS;                            // FAC is zero, the ROM returns with nothing changed
+    if (!fp_begin()) return NATIVE_DECLINE;
+    fp_fmultt(0);
+    return fp_end();
+}
+
+uint8_t native_fdiv() {
+    if (!fp_begin()) return NATIVE_DECLINE;
+    fp_fdiv();
+    return fp_end();
+}
+
+uint8_t native_fdivt() {
+    if (!fp_begin()) return NATIVE_DECLINE;
+    fp_fdivt(fp_entry_zero());
+    return fp_end();
+}
+
+
+void basic_float_register_traps() {
+    native_trap_register(0xB850, NATIVE_TRAP_BASIC, native_fsub);
+    native_trap_register(0xB853, NATIVE_TRAP_BASIC, native_fsubt);
+    native_trap_register(0xB867, NATIVE_TRAP_BASIC, native_fadd);
+    native_trap_register(0xB86A, NATIVE_TRAP_BASIC, native_faddt);
+    native_trap_register(0xBA28, NATIVE_TRAP_BASIC, native_fmult);
+    native_trap_register(0xBA2B, NATIVE_TRAP_BASIC, native_fmultt);
+    native_trap_register(0xBB0F, NATIVE_TRAP_BASIC, native_fdiv);
+    native_trap_register(0xBB12, NATIVE_TRAP_BASIC, native_fdivt);
+    return;
+}
+
+#endif // ENABLE_ACCELERATION
+
+#endif // BASIC_FLOAT_H
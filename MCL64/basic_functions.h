@@ -0,0 +1,415 @@
+// ============================================================================
+// MCL64 - Native BASIC Functions
+// ----------------------------------------------------------------------------
+// SIN, COS, TAN, ATN, LOG, EXP, SQR and the power operator run as native
+// traps.  They are translated from BASIC_ROM and KERNAL_ROM the same way as
+// the arithmetic in basic_float.h and call its routines where the ROM calls
+// FADD, FMULT, MOVMF and the others, so the series are evaluated by POLY
+// and POLYX from the ROM's own constant tables and every intermediate is
+// rounded as the 6502 code rounds it.  The results, the zero page and the
+// registers on return are the same as the ROM leaves them.
+//
+//  $E264 COS    $E26B SIN    $E2B4 TAN    $E30E ATN
+//  $B9EA LOG    $BFED EXP    $BF71 SQR    $BF7B FPWRT  FAC = ARG ^ FAC
+//  $E043 POLYX  $E059 POLY   Series at (A,Y) in x^2 / x
+//
+// The routines call between both ROMs, so the traps are registered for
+// NATIVE_TRAP_ROMS and only fire while BASIC and KERNAL are mapped in.
+// ============================================================================
+
+#ifndef BASIC_FUNCTIONS_H
+#define BASIC_FUNCTIONS_H
+
+#if ENABLE_ACCELERATION
+
+#define FP_ERROR_ILLEGAL_QUANTITY   0x0E
+
+
+// -------------------------------------------------
+// $E059 POLY - Series in FAC with the table at (A,Y)
+//  $E043 POLYX evaluates the series in FAC^2 and multiplies by FAC
+// -------------------------------------------------
+void fp_poly_saved() {                                               // $E05D, table pointer in $71/$72
+    FP_JSR(0xE05F, fp_movmf_5c());
+    fp_a = read_byte( (ZP(0x71) | (ZP(0x72)<<8)) + fp_y );
+    ZP(0x67) = fp_a;
+    fp_y = ZP(0x71) + 1;
+    fp_nz = fp_a = fp_y;
+    if (fp_a==0) fp_inc(0x72);
+    ZP(0x71) = fp_a;
+    fp_nz = fp_y = ZP(0x72);
+
+    do {
+      FP_JSR(0xE072, fp_fmult());
+      fp_a = ZP(0x71);
+      fp_y = ZP(0x72);
+      fp_c = 0;
+      fp_adc(0x05);
+      if (fp_c) fp_nz = ++fp_y;
+      ZP(0x71) = fp_a;
+      ZP(0x72) = fp_y;
+      FP_JSR(0xE083, fp_fadd());
+      fp_a = 0x5C;
+      fp_y = 0x00;
+      fp_nz = --ZP(0x67);
+    } while (fp_nz!=0);
+    return;
+}
+
+void fp_poly() {
+    ZP(0x71) = fp_a;
+    ZP(0x72) = fp_y;
+    fp_poly_saved();
+    return;
+}
+
+void fp_polyx() {
+    ZP(0x71) = fp_a;
+    ZP(0x72) = fp_y;
+    FP_JSR(0xE049, fp_movmf_57());
+    fp_a = 0x57;
+    FP_JSR(0xE04E, fp_fmult());
+    FP_JSR(0xE051, fp_poly_saved());
+    fp_a = 0x57;
+    fp_y = 0x00;
+    fp_fmult();
+    return;
+}
+
+
+// -------------------------------------------------
+// $B9EA LOG
+// -------------------------------------------------
+void fp_log() {
+    fp_sign();
+    if (fp_nz==0 || (fp_nz&0x80)) {
+      fp_raise(FP_ERROR_ILLEGAL_QUANTITY);
+      return;
+    }
+    fp_a = ZP(0x61);
+    fp_sbc(0x7F);
+    fp_push(fp_a);
+    fp_a = 0x80;
+    ZP(0x61) = fp_a;
+    fp_a = 0xD6;  fp_y = 0xB9;  FP_JSR(0xBA03, fp_fadd());
+    fp_a = 0xDB;  fp_y = 0xB9;  FP_JSR(0xBA0A, fp_fdiv());
+    fp_a = 0xBC;  fp_y = 0xB9;  FP_JSR(0xBA11, fp_fsub());
+    fp_a = 0xC1;  fp_y = 0xB9;  FP_JSR(0xBA18, fp_polyx());
+    fp_a = 0xE0;  fp_y = 0xB9;  FP_JSR(0xBA1F, fp_fadd());
+    fp_nz = fp_a = fp_pull();
+    FP_JSR(0xBA23, fp_add_signed_a());
+    fp_a = 0xE5;
+    fp_y = 0xB9;
+    fp_fmult();
+    return;
+}
+
+
+// -------------------------------------------------
+// $BFED EXP
+// -------------------------------------------------
+void fp_exp() {
+    fp_a = 0xBF;
+    fp_y = 0xBF;
+    FP_JSR(0xBFF3, fp_fmult());
+    fp_a = ZP(0x70);
+    fp_adc(0x50);
+    if (fp_c) FP_JSR(0xBFFC, fp_round_up());
+
+    ZP(0x56) = fp_a;                                                  // $E000 in KERNAL_ROM
+    fp_movaf_unrounded();
+    fp_a = ZP(0x61);
+    fp_cmp(fp_a, 0x88);
+    if (fp_c) {
+      fp_call(0xE00D);
+      fp_out_of_range();
+      fp_return();
+      return;
+    }
+    FP_JSR(0xE010, fp_int());
+    fp_a = ZP(0x07);
+    fp_c = 0;
+    fp_adc(0x81);
+    if (fp_nz==0) {
+      fp_call(0xE00D);
+      fp_out_of_range();
+      fp_return();
+      return;
+    }
+    fp_c = 1;
+    fp_sbc(0x01);
+    fp_push(fp_a);
+
+    fp_x = 0x05;                                                      // Swap FAC and ARG
+    do {
+      fp_a = ZP(0x69+fp_x);
+      fp_y = ZP(0x61+fp_x);
+      ZP(0x69+fp_x) = fp_y;
+      ZP(0x61+fp_x) = fp_a;
+      fp_nz = --fp_x;
+    } while ((fp_nz&0x80)==0);
+
+    fp_a = ZP(0x56);
+    ZP(0x70) = fp_a;
+    FP_JSR(0xE02F, fp_fsubt());
+    fp_negop();
+    fp_a = 0xC4;
+    fp_y = 0xBF;
+    FP_JSR(0xE039, fp_poly());
+    fp_a = 0x00;
+    ZP(0x6F) = fp_a;
+    fp_nz = fp_a = fp_pull();
+    fp_call(0xE041);
+    fp_muldiv_a();
+    fp_return();
+    return;
+}
+
+
+// -------------------------------------------------
+// $BF7B FPWRT - FAC = ARG ^ FAC, Z set when FAC is zero
+//  $BF71 SQR loads ARG with the square root exponent 0.5
+// -------------------------------------------------
+void fp_fpwrt(uint8_t zero) {
+    if (zero) {
+      fp_exp();
+      return;
+    }
+    fp_nz = fp_a = ZP(0x69);
+    if (fp_a==0) {                                                    // $B8F9, 0^x
+      ZP(0x61) = fp_a;
+      ZP(0x66) = fp_a;
+      return;
+    }
+    fp_x = 0x4E;
+    fp_y = 0x00;
+    FP_JSR(0xBF8A, fp_movmf());
+    fp_nz = fp_a = ZP(0x6E);
+    if (fp_a&0x80) {                                                  // Negative base, the result is negative for an odd integer power
+      FP_JSR(0xBF91, fp_int());
+      fp_a = 0x4E;
+      fp_y = 0x00;
+      fp_fcomp();
+      if (fp_nz==0) {
+        fp_nz = fp_a = fp_y;
+        fp_nz = fp_y = ZP(0x07);
+      }
+    }
+    fp_movfa_sign();
+    fp_nz = fp_a = fp_y;
+    fp_push(fp_a);
+    FP_JSR(0xBFA5, fp_log());
+    fp_a = 0x4E;
+    fp_y = 0x00;
+    FP_JSR(0xBFAC, fp_fmult());
+    FP_JSR(0xBFAF, fp_exp());
+    fp_nz = fp_a = fp_pull();
+    fp_lsr_a();
+    if (fp_c) fp_negop();
+    return;
+}
+
+void fp_sqr() {
+    FP_JSR(0xBF73, fp_movaf());
+    fp_a = 0x11;
+    fp_y = 0xBF;
+    fp_movfm();
+    fp_fpwrt(fp_nz==0);
+    return;
+}
+
+
+// -------------------------------------------------
+// $E26B SIN, $E264 COS and $E2B4 TAN
+//  The series at $E29D runs with the quadrant byte SIN pushed still on
+//  the stack; TAN enters it with the sign flag $12
+// -------------------------------------------------
+void fp_sin_series(uint8_t negate) {
+    if (negate) fp_negop();
+    fp_a = 0xEA;
+    fp_y = 0xE2;
+    FP_JSR(0xE2A6, fp_fadd());
+    fp_nz = fp_a = fp_pull();
+    if (fp_a&0x80) fp_negop();
+    fp_a = 0xEF;
+    fp_y = 0xE2;
+    fp_polyx();
+    return;
+}
+
+void fp_sin() {
+    FP_JSR(0xE26D, fp_movaf());
+    fp_a = 0xE5;
+    fp_y = 0xE2;
+    fp_nz = fp_x = ZP(0x6E);
+    FP_JSR(0xE276, fp_fdiv_into());
+    FP_JSR(0xE279, fp_movaf());
+    FP_JSR(0xE27C, fp_int());
+    fp_a = 0x00;
+    ZP(0x6F) = fp_a;
+    FP_JSR(0xE283, fp_fsubt());
+    fp_a = 0xEA;
+    fp_y = 0xE2;
+    FP_JSR(0xE28A, fp_fsub());
+    fp_nz = fp_a = ZP(0x66);
+    fp_push(fp_a);
+    if (fp_a&0x80) {
+      FP_JSR(0xE292, fp_faddh());
+      fp_nz = fp_a = ZP(0x66);
+      if (fp_a&0x80) {
+        fp_sin_series(0);
+        return;
+      }
+      fp_nz = fp_a = ZP(0x12) ^ 0xFF;
+      ZP(0x12) = fp_a;
+    }
+    fp_sin_series(1);
+    return;
+}
+
+void fp_cos() {
+    fp_a = 0xE0;
+    fp_y = 0xE2;
+    FP_JSR(0xE26A, fp_fadd());
+    fp_sin();
+    return;
+}
+
+void fp_tan() {
+    FP_JSR(0xE2B6, fp_movmf_57());
+    fp_a = 0x00;
+    ZP(0x12) = fp_a;
+    FP_JSR(0xE2BD, fp_sin());
+    fp_x = 0x4E;
+    fp_y = 0x00;
+    FP_JSR(0xE2C4, fp_movmf());
+    fp_a = 0x57;
+    fp_y = 0x00;
+    fp_movfm();
+    fp_a = 0x00;
+    ZP(0x66) = fp_a;
+    fp_nz = fp_a = ZP(0x12);
+    fp_call(0xE2D4);                                                  // $E2DC pushes the flag and joins SIN
+    fp_push(fp_a);
+    fp_sin_series(1);
+    fp_return();
+    if (fp_error) return;
+    fp_a = 0x4E;
+    fp_y = 0x00;
+    fp_fdiv();
+    return;
+}
+
+
+// -------------------------------------------------
+// $E30E ATN
+// -------------------------------------------------
+void fp_atn() {
+    fp_nz = fp_a = ZP(0x66);
+    fp_push(fp_a);
+    if (fp_a&0x80) fp_negop();
+    fp_nz = fp_a = ZP(0x61);
+    fp_push(fp_a);
+    fp_cmp(fp_a, 0x81);
+    if (fp_c) {                                                       // |x| >= 1, use 1/x
+      fp_a = 0xBC;
+      fp_y = 0xB9;
+      FP_JSR(0xE323, fp_fdiv());
+    }
+    fp_a = 0x3E;
+    fp_y = 0xE3;
+    FP_JSR(0xE32A, fp_polyx());
+    fp_nz = fp_a = fp_pull();
+    fp_cmp(fp_a, 0x81);
+    if (fp_c) {
+      fp_a = 0xE0;
+      fp_y = 0xE2;
+      FP_JSR(0xE336, fp_fsub());
+    }
+    fp_nz = fp_a = fp_pull();
+    if (fp_a&0x80) fp_negop();
+    return;
+}
+
+
+// -------------------------------------------------
+// Trap handlers
+// -------------------------------------------------
+uint8_t native_cos() {
+    if (!fp_begin()) return NATIVE_DECLINE;
+    fp_cos();
+    return fp_end();
+}
+
+uint8_t native_sin() {
+    if (!fp_begin()) return NATIVE_DECLINE;
+    fp_sin();
+    return fp_end();
+}
+
+uint8_t native_tan() {
+    if (!fp_begin()) return NATIVE_DECLINE;
+    fp_tan();
+    return fp_end();
+}
+
+uint8_t native_atn() {
+    if (!fp_begin()) return NATIVE_DECLINE;
+    fp_atn();
+    return fp_end();
+}
+
+uint8_t native_log() {
+    if (!fp_begin()) return NATIVE_DECLINE;
+    fp_log();
+    return fp_end();
+}
+
+uint8_t native_exp() {
+    if (!fp_begin()) return NATIVE_DECLINE;
+    fp_exp();
+    return fp_end();
+}
+
+uint8_t native_sqr() {
+    if (!fp_begin()) return NATIVE_DECLINE;
+    fp_sqr();
+    return fp_end();
+}
+
+uint8_t native_fpwrt() {
+    if (!fp_begin()) return NATIVE_DECLINE;
+    fp_fpwrt(fp_entry_zero());
+    return fp_end();
+}
+
+uint8_t native_polyx() {
+    if (!fp_begin()) return NATIVE_DECLINE;
+    fp_polyx();
+    return fp_end();
+}
+
+uint8_t native_poly() {
+    if (!fp_begin()) return NATIVE_DECLINE;
+    fp_poly();
+    return fp_end();
+}
+
+
+void basic_functions_register_traps() {
+    native_trap_register(0xE264, NATIVE_TRAP_ROMS, native_cos);
+    native_trap_register(0xE26B, NATIVE_TRAP_ROMS, native_sin);
+    native_trap_register(0xE2B4, NATIVE_TRAP_ROMS, native_tan);
+    native_trap_register(0xE30E, NATIVE_TRAP_ROMS, native_atn);
+    native_trap_register(0xB9EA, NATIVE_TRAP_ROMS, native_log);
+    native_trap_register(0xBFED, NATIVE_TRAP_ROMS, native_exp);
+    native_trap_register(0xBF71, NATIVE_TRAP_ROMS, native_sqr);
+    native_trap_register(0xBF7B, NATIVE_TRAP_ROMS, native_fpwrt);
+    native_trap_register(0xE043, NATIVE_TRAP_ROMS, native_polyx);
+    native_trap_register(0xE059, NATIVE_TRAP_ROMS, native_poly);
+    return;
+}
+
+#endif // ENABLE_ACCELERATION
+
+#endif // BASIC_FUNCTIONS_H
@@ -0,0 +1,232 @@
+// ============================================================================
+// MCL64 - Native BASIC String Garbage Collection
+// ----------------------------------------------------------------------------
+// GARBAG ($B526) compacts string space by finding the highest string below
+// FRETOP, moving it up under FRETOP with BLTU and lowering FRETOP, then
+// scanning every descriptor again for the next one.  With n strings this
+// is n scans of all the variables, which can take minutes.
+//
+// The trap scans the descriptors once, in the ROM's order: the temporary
+// descriptors from $19 to $16, the string variables from VARTAB to ARYTAB
+// and the elements of the string arrays from ARYTAB to STREND.  Sorted by
+// pointer, highest first and the last scanned first among equal pointers,
+// they are in the order the ROM picks them, and are moved the same way:
+// top down, one string at a time, updating only the picked descriptor.
+// String space, the descriptors and FRETOP ($33/$34) end up as the ROM
+// leaves them, and so do the scratch bytes, the registers and the flags
+// of its final scan.
+//
+// The trap declines when a scan of the ROM would not end, when a string
+// would be moved below STREND or more than GC_DESCRIPTORS_MAX strings are
+// found, in decimal mode, and when the temporary descriptors are not
+// stepped by 3.
+// ============================================================================
+
+#ifndef BASIC_GARBAGE_H
+#define BASIC_GARBAGE_H
+
+#if ENABLE_ACCELERATION
+
+#define GC_DESCRIPTORS_MAX  8192
+
+struct gc_descriptor {
+  uint16_t  address;                  // Length, then the pointer
+  uint16_t  pointer;
+  uint8_t   length;
+};
+
+gc_descriptor gc_descriptors[GC_DESCRIPTORS_MAX];
+uint16_t  gc_count;
+uint16_t  gc_bottom;                  // STREND, strings below are in the program text
+uint16_t  gc_top;                     // MEMSIZ, then FRETOP as strings are moved
+uint16_t  gc_scan_end;                // $22/$23 left by the scan
+uint8_t   gc_overflow;                // V flag left by the scan, 0xFF unchanged
+
+
+// -------------------------------------------------
+// Descriptors are in zero page or in the variable area
+// -------------------------------------------------
+inline uint8_t gc_read(uint16_t address) {
+    if (address<0x100) return internal_RAM[address];
+    return read_byte(address);
+}
+
+inline void gc_write(uint16_t address, uint8_t data) {
+    if (address<0x100) internal_RAM[address] = data;
+    else write_byte(address, data);
+    return;
+}
+
+// V flag of ADC
+inline uint8_t gc_adc_overflow(uint8_t data_a, uint8_t data_m, uint8_t carry) {
+  uint8_t sum = data_a + data_m + carry;
+
+    return ((~(data_a^data_m) & (data_a^sum) & 0x80)!=0);
+}
+
+
+// -------------------------------------------------
+// Add the descriptor at address if the ROM could pick it
+//  Return: 0 when the table is full
+// -------------------------------------------------
+uint8_t gc_add(uint16_t address) {
+  uint16_t pointer;
+  uint8_t  length;
+
+    length  = gc_read(address);
+    pointer = gc_read(address+1) | (gc_read(address+2)<<8);
+    if (length==0 || pointer<gc_bottom || pointer>=gc_top) return 1;
+    if (gc_count==GC_DESCRIPTORS_MAX) return 0;
+
+    gc_descriptors[gc_count].address = address;
+    gc_descriptors[gc_count].pointer = pointer;
+    gc_descriptors[gc_count].length  = length;
+    gc_count++;
+    return 1;
+}
+
+
+// -------------------------------------------------
+// One scan of the descriptors as $B52E-$B606 does
+//  Return: 0 when the ROM scan would not end at $16, ARYTAB or STREND
+// -------------------------------------------------
+uint8_t gc_scan() {
+  uint16_t vartab = internal_RAM[0x2D] | (internal_RAM[0x2E]<<8);
+  uint16_t arytab = internal_RAM[0x2F] | (internal_RAM[0x30]<<8);
+  uint16_t address;
+  uint16_t element;
+  uint16_t size;
+  uint32_t next;
+  uint8_t  dimensions;
+
+    gc_bottom   = internal_RAM[0x31] | (internal_RAM[0x32]<<8);
+    gc_top      = internal_RAM[0x37] | (internal_RAM[0x38]<<8);
+    gc_count    = 0;
+    gc_overflow = 0xFF;
+
+    if (internal_RAM[0x16]!=0x19) {                                    // Stepped by $53, which the ROM leaves at 3
+      if (internal_RAM[0x53]!=0x3 || internal_RAM[0x16]<0x19 || internal_RAM[0x16]>0x22 || (internal_RAM[0x16]-0x19)%3!=0) return 0;
+      for (address=0x19; address!=internal_RAM[0x16]; address+=3) {
+        if (!gc_add(address)) return 0;
+        gc_overflow = 0x0;
+      }
+    }
+
+    if (vartab<0x100 || arytab<vartab || gc_bottom<arytab || (arytab-vartab)%7!=0) return 0;
+    for (address=vartab; address!=arytab; address+=7) {
+      if ((read_byte(address)&0x80)==0 && (read_byte(address+1)&0x80)!=0 && !gc_add(address+2)) return 0;
+      gc_overflow = gc_adc_overflow(0x07, address, 0);
+    }
+    gc_scan_end = arytab;
+
+    for (address=arytab; address!=gc_bottom; address=next) {
+      if (address>0xFFFA) return 0;
+      size = read_byte(address+2) | (read_byte(address+3)<<8);
+      next = (uint32_t)address + size;
+      if (size==0 || next>gc_bottom) return 0;
+      gc_scan_end = address;                                           // The size is added between PHP and PLP
+
+      if ((read_byte(address)&0x80)==0 && (read_byte(address+1)&0x80)!=0) {
+        dimensions = read_byte(address+4);
+        if (dimensions>=0x7D) return 0;                                // 5+2*dimensions is added as one byte
+        element = address + 5 + (dimensions<<1);
+        if (element>next || (next-element)%3!=0) return 0;
+        gc_overflow = gc_adc_overflow(5 + (dimensions<<1), address, 0);
+
+        for ( ; element!=next; element+=3) {
+          if (!gc_add(element)) return 0;
+          gc_overflow = gc_adc_overflow(0x03, element, 0);
+        }
+        gc_scan_end = next;
+      }
+    }
+    return 1;
+}
+
+
+// Highest pointer first, then the last scanned
+int gc_compare(const void *first, const void *second) {
+  const gc_descriptor *a = (const gc_descriptor *)first;
+  const gc_descriptor *b = (const gc_descriptor *)second;
+
+    if (a->pointer!=b->pointer) return (a->pointer<b->pointer) ? 1 : -1;
+    return (a->address<b->address) ? 1 : -1;
+}
+
+
+// -------------------------------------------------
+// $B526 - GARBAG
+// -------------------------------------------------
+uint8_t native_garbag() {
+  gc_descriptor *descriptor;
+  uint16_t i;
+  uint16_t top;
+  uint16_t offset;
+  uint16_t moved=0xFFFF;
+  uint16_t moved_pointer=0;
+
+    if ((register_flags&0x08) || !native_zero_page_begin()) return NATIVE_DECLINE;
+    if (!gc_scan()) return NATIVE_DECLINE;
+    qsort(gc_descriptors, gc_count, sizeof(gc_descriptor), gc_compare);
+
+    top = gc_top;                                                      // Moves below STREND would overwrite descriptors
+    for (i=0; i<gc_count; i++) {
+      descriptor = &gc_descriptors[i];
+      if (descriptor->pointer>=top) continue;
+      if (top - gc_bottom < descriptor->length) return NATIVE_DECLINE;
+      top -= descriptor->length;
+    }
+
+    top = gc_top;
+    for (i=0; i<gc_count; i++) {
+      descriptor = &gc_descriptors[i];
+      if (descriptor->pointer>=top) continue;                          // Moved already, or overwritten by a move
+      top -= descriptor->length;
+
+      if (top!=descriptor->pointer) {
+        for (offset=descriptor->length; offset>0; offset--) {         // Top down as BLTU, also for overlapping strings
+          write_byte(top+offset-1, read_byte(descriptor->pointer+offset-1));
+        }
+        gc_write(descriptor->address+1, top);
+        gc_write(descriptor->address+2, top>>8);
+      }
+      moved = descriptor->address;
+      moved_pointer = descriptor->pointer;
+    }
+
+    if (moved!=0xFFFF) {                                               // Left by the last move and BLTU
+      internal_RAM[0x55] = (moved>=0x100 && moved<(internal_RAM[0x2F] | (internal_RAM[0x30]<<8))) ? 0x2 : 0x0;
+      internal_RAM[0x5A] = moved_pointer;
+      internal_RAM[0x5B] = (moved_pointer>>8) - 1;
+    }
+
+    internal_RAM[0x33] = top;                                          // FRETOP
+    internal_RAM[0x34] = top >> 8;
+    internal_RAM[0x4E] = 0x0;
+    internal_RAM[0x4F] = 0x0;
+    internal_RAM[0x53] = 0x3;
+    internal_RAM[0x58] = internal_RAM[0x31];
+    internal_RAM[0x59] = internal_RAM[0x32];
+    internal_RAM[0x5F] = internal_RAM[0x31];
+    internal_RAM[0x60] = internal_RAM[0x32];
+    internal_RAM[0x22] = gc_scan_end;
+    internal_RAM[0x23] = gc_scan_end >> 8;
+
+    register_a = 0x0;
+    register_x = gc_scan_end >> 8;
+    register_y = 0x0;
+    register_flags = (register_flags & 0x7C) | 0x03;
+    if (gc_overflow!=0xFF) register_flags = (register_flags & 0xBF) | (gc_overflow<<6);
+    native_zero_page_end();
+    return NATIVE_RTS;
+}
+
+
+void basic_garbage_register_traps() {
+    native_trap_register(0xB526, NATIVE_TRAP_BASIC, native_garbag);
+    return;
+}
+
+#endif // ENABLE_ACCELERATION
+
+#endif // BASIC_GARBAGE_H
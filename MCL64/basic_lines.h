@@ -0,0 +1,207 @@
+// ============================================================================
+// MCL64 - BASIC Line Index
+// ----------------------------------------------------------------------------
+// FNDLIN ($A613) walks the line links from TXTTAB on every GOTO, GOSUB and
+// THEN, and $A617 walks from a given line when GOTO jumps forward.  The
+// trap answers both with a binary search of a sorted index of the line
+// numbers and their addresses, built from the links on first use.
+//
+// Any write_byte() to the program text, to the link bytes read while
+// building the index, or to TXTTAB/VARTAB ($2B-$2E) drops the index, and
+// it is rebuilt at the next search.  A program whose line numbers or
+// addresses do not ascend along the links, or that has more than
+// LINE_INDEX_MAX lines, is left to the ROM walk.
+//
+// The trap leaves $5F/$60, A, X, Y and the flags as the ROM walk would.
+// ============================================================================
+
+#ifndef BASIC_LINES_H
+#define BASIC_LINES_H
+
+#if ENABLE_ACCELERATION
+
+#define LINE_INDEX_MAX      4096
+
+#define LINE_INDEX_EMPTY    0x0       // Rebuild at the next search
+#define LINE_INDEX_VALID    0x1
+#define LINE_INDEX_UNUSABLE 0x2       // Links out of order, use the ROM until the text changes
+
+uint16_t  line_index_number[LINE_INDEX_MAX];
+uint16_t  line_index_address[LINE_INDEX_MAX];
+uint16_t  line_index_count=0;
+uint16_t  line_index_end=0;           // Address of the link with a zero high byte
+uint8_t   line_index_state=LINE_INDEX_EMPTY;
+
+uint16_t  line_index_watch_start=0;   // Bytes the index was built from
+uint16_t  line_index_watch_end=0;     // 0 when there is nothing to watch
+
+
+// -------------------------------------------------
+// Called by write_byte() for addresses below line_index_watch_end
+// -------------------------------------------------
+inline void line_index_write(uint16_t local_address) {
+    if (local_address>=line_index_watch_start || (local_address>=0x2B && local_address<=0x2E)) {
+      line_index_state     = LINE_INDEX_EMPTY;
+      line_index_watch_end = 0;
+    }
+    return;
+}
+
+// For memory written without write_byte(), start to end-1
+inline void line_index_write_range(uint16_t start, uint32_t end) {
+    if ((start<line_index_watch_end && end>line_index_watch_start) || (start<=0x2E && end>0x2B)) {
+      line_index_state     = LINE_INDEX_EMPTY;
+      line_index_watch_end = 0;
+    }
+    return;
+}
+
+
+// -------------------------------------------------
+// Walk the links from TXTTAB
+// -------------------------------------------------
+void line_index_build() {
+  uint16_t address;
+  uint16_t number;
+
+    address = internal_RAM[0x2B] | (internal_RAM[0x2C]<<8);
+    line_index_watch_start = address;
+    line_index_watch_end   = (internal_RAM[0x2D] | (internal_RAM[0x2E]<<8));
+    line_index_count = 0;
+    line_index_state = LINE_INDEX_UNUSABLE;
+
+    while (address>=line_index_watch_start && address<=0xFFFB && read_byte(address+1)!=0) {
+      number = read_byte(address+2) | (read_byte(address+3)<<8);
+      if (line_index_count==LINE_INDEX_MAX) break;
+      if (line_index_count!=0 && (number<=line_index_number[line_index_count-1] || address<=line_index_address[line_index_count-1])) break;
+
+      line_index_number[line_index_count]  = number;
+      line_index_address[line_index_count] = address;
+      line_index_count++;
+      if (address+4 > line_index_watch_end) line_index_watch_end = address+4;
+      address = read_byte(address) | (read_byte(address+1)<<8);
+    }
+
+    if (line_index_watch_end<=line_index_watch_start) line_index_watch_end = line_index_watch_start + (line_index_watch_start!=0xFFFF);
+    if (line_index_watch_end<=0x2E) line_index_watch_end = 0x2F;
+
+    if (address>=line_index_watch_start && address<=0xFFFB && read_byte(address+1)==0 &&
+        (line_index_count==0 || address>line_index_address[line_index_count-1])) {
+      line_index_end   = address;
+      line_index_state = LINE_INDEX_VALID;
+      if (address+2 > line_index_watch_end) line_index_watch_end = address+2;
+    }
+    return;
+}
+
+
+// -------------------------------------------------
+// First entry at or after position start with a line number >= target
+// -------------------------------------------------
+uint16_t line_index_search(uint16_t start, uint16_t target) {
+  uint16_t low  = start;
+  uint16_t high = line_index_count;
+  uint16_t middle;
+
+    while (low<high) {
+      middle = (low+high) >> 1;
+      if (line_index_number[middle]<target) low  = middle+1;
+      else                                  high = middle;
+    }
+    return low;
+}
+
+// Position of the line at address, line_index_count for the end of the program
+//  Return: 0xFFFF when address is not the start of a line
+uint16_t line_index_position(uint16_t address) {
+  uint16_t low  = 0;
+  uint16_t high = line_index_count;
+  uint16_t middle;
+
+    if (address==line_index_end) return line_index_count;
+    while (low<high) {
+      middle = (low+high) >> 1;
+      if (line_index_address[middle]<address) low  = middle+1;
+      else                                    high = middle;
+    }
+    if (low<line_index_count && line_index_address[low]==address) return low;
+    return 0xFFFF;
+}
+
+
+// -------------------------------------------------
+// Search from the line at address for LINNUM ($14/$15)
+//  Return: 0 when the index cannot answer
+// -------------------------------------------------
+uint8_t line_index_find(uint16_t address) {
+  uint16_t position;
+  uint16_t target;
+  uint16_t line_address;
+  uint8_t  line_high;
+  uint8_t  result;
+
+    if (!native_zero_page_begin()) return 0;
+    if (line_index_state==LINE_INDEX_EMPTY) line_index_build();
+    if (line_index_state!=LINE_INDEX_VALID) return 0;
+
+    position = line_index_position(address);
+    if (position==0xFFFF) return 0;
+
+    target   = internal_RAM[0x14] | (internal_RAM[0x15]<<8);
+    position = line_index_search(position, target);
+    register_flags &= 0x7C;
+
+    if (position==line_index_count) {                                  // Not found, C clear and Z from the zero link
+      line_address    = line_index_end;
+      register_a      = 0x0;
+      register_y      = 0x1;
+      register_flags |= 0x02;
+    }
+    else {
+      line_address = line_index_address[position];
+      line_high    = line_index_number[position] >> 8;
+      if (internal_RAM[0x15]!=line_high) {                             // Stopped on the high byte
+        register_a = internal_RAM[0x15];
+        register_y = 0x3;
+        result     = register_a - line_high;
+      }
+      else {
+        register_a = internal_RAM[0x14];
+        register_y = 0x2;
+        result     = register_a - (line_index_number[position]&0xFF);
+        if (result==0) register_flags |= 0x01;
+      }
+      register_flags |= (result&0x80) | ((result==0) ? 0x02 : 0x00);
+    }
+
+    internal_RAM[0x5F] = line_address;
+    internal_RAM[0x60] = line_address >> 8;
+    register_x = line_address >> 8;
+    native_zero_page_end();
+    return 1;
+}
+
+
+// -------------------------------------------------
+// Trap handlers
+// -------------------------------------------------
+uint8_t native_fndlin() {
+    if (!line_index_find(internal_RAM[0x2B] | (internal_RAM[0x2C]<<8))) return NATIVE_DECLINE;
+    return NATIVE_RTS;
+}
+
+uint8_t native_fndlin_from() {
+    if (!line_index_find(register_a | (register_x<<8))) return NATIVE_DECLINE;
+    return NATIVE_RTS;
+}
+
+
+void basic_lines_register_traps() {
+    native_trap_register(0xA613, NATIVE_TRAP_BASIC, native_fndlin);
+    native_trap_register(0xA617, NATIVE_TRAP_BASIC, native_fndlin_from);
+    return;
+}
+
+#endif // ENABLE_ACCELERATION
+
+#endif // BASIC_LINES_H
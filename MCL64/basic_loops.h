@@ -0,0 +1,155 @@
+// ============================================================================
+// MCL64 - Native BASIC FOR/NEXT
+// ----------------------------------------------------------------------------
+// NEXT ($AD1E) finds its FOR frame on the stack with FNDFOR, adds the STEP
+// to the loop variable with FADD, stores it with MOVMF and compares it with
+// the limit with FCOMP, each a JSR into the float code.  The trap at $AD27,
+// reached once PTRGET has found the variable named after NEXT (or with
+// A/Y = 0 for a plain NEXT), runs the whole step natively on the
+// basic_float.h routines and continues at NEWSTT ($A7AE) for the next
+// pass or at $AD7D when the loop ends, where the ROM looks for a comma.
+//
+// FOR frames are 18 bytes on the stack below NEXT's return address:
+//  +0  $81          +1  variable     +3  STEP         +8  STEP sign
+//  +9  limit        +14 line number  +16 TXTPTR high, low
+//
+// FNDFOR ($A38A), which FOR and RETURN also call, has its own trap.  The
+// NEXT trap declines when no frame is found, so NEXT WITHOUT FOR is raised
+// by the ROM.  An overflow in FADD or MOVMF reaches the error handler with
+// the ROM's stack.  The stack bytes the ROM would leave below SP are not
+// written.
+// ============================================================================
+
+#ifndef BASIC_LOOPS_H
+#define BASIC_LOOPS_H
+
+#if ENABLE_ACCELERATION
+
+#define FOR_FRAME_MARKER    0x81
+#define FOR_FRAME_SIZE      0x12
+
+uint16_t  fp_next_pc;                 // Where NEXT continues
+
+
+// -------------------------------------------------
+// $A38A FNDFOR - Find the FOR frame of the variable at $49/$4A
+//  fp_x is the stack pointer after the JSR, any frame when $4A is 0
+//  Return: fp_nz==0 and the frame at $0101+fp_x when found
+// -------------------------------------------------
+void fp_fndfor() {
+
+    fp_x += 4;
+    while (1) {
+      fp_a = read_byte(0x0101 + fp_x);
+      fp_cmp(fp_a, FOR_FRAME_MARKER);
+      if (fp_nz!=0) return;
+
+      fp_nz = fp_a = ZP(0x4A);
+      if (fp_a==0) {                                                   // NEXT without a variable takes the innermost loop
+        ZP(0x49) = read_byte(0x0102 + fp_x);
+        fp_nz = fp_a = read_byte(0x0103 + fp_x);
+        ZP(0x4A) = fp_a;
+      }
+      fp_cmp(fp_a, read_byte(0x0103 + fp_x));
+      if (fp_nz==0) {
+        fp_a = ZP(0x49);
+        fp_cmp(fp_a, read_byte(0x0102 + fp_x));
+        if (fp_nz==0) return;
+      }
+
+      fp_a = fp_x;
+      fp_c = 0;
+      fp_adc(FOR_FRAME_SIZE);
+      fp_x = fp_a;
+      if (fp_nz==0) return;                                            // The ROM takes X wrapping to 0 as found
+    }
+}
+
+
+// -------------------------------------------------
+// $AD35 - Step the loop of the frame at $0101+X
+// -------------------------------------------------
+void fp_next_step() {
+  uint8_t step;
+
+    register_sp = fp_x;                                                // TXS drops the frames above
+    fp_a = fp_x;
+    fp_c = 0;
+    fp_adc(0x04);
+    step = fp_a;
+    fp_adc(0x06);
+    ZP(0x24) = fp_a;                                                   // Address of the limit for FCOMP
+    fp_nz = fp_a = step;
+
+    fp_y = 0x1;
+    FP_JSR(0xAD44, fp_movfm());                                        // FAC = STEP
+    fp_x = register_sp;
+    fp_nz = fp_a = read_byte(0x0109 + fp_x);
+    ZP(0x66) = fp_a;
+    fp_a = ZP(0x49);
+    fp_y = ZP(0x4A);
+    FP_JSR(0xAD51, fp_fadd());                                         // FAC = variable + STEP
+    FP_JSR(0xAD54, fp_movmf_forpnt());
+    fp_y = 0x1;
+    fp_a = ZP(0x24);
+    FP_JSR(0xAD59, fp_fcomp());
+
+    fp_x = register_sp;
+    fp_c = 1;
+    fp_sbc(read_byte(0x0109 + fp_x));                                  // Compare result against the STEP sign
+    if (fp_nz==0) {                                                    // Loop ended, drop the frame
+      fp_a = fp_x;
+      fp_adc(0x11);
+      fp_x = fp_a;
+      register_sp = fp_x;
+      fp_next_pc = 0xAD7D;
+      return;
+    }
+
+    ZP(0x39) = read_byte(0x010F + fp_x);                               // CURLIN and TXTPTR of the FOR statement
+    ZP(0x3A) = read_byte(0x0110 + fp_x);
+    ZP(0x7A) = read_byte(0x0112 + fp_x);
+    fp_nz = fp_a = read_byte(0x0111 + fp_x);
+    ZP(0x7B) = fp_a;
+    fp_next_pc = 0xA7AE;
+    return;
+}
+
+
+// -------------------------------------------------
+// Trap handlers
+// -------------------------------------------------
+uint8_t native_fndfor() {
+    if (!fp_begin()) return NATIVE_DECLINE;
+    fp_x = register_sp;
+    fp_fndfor();
+    return fp_end();
+}
+
+uint8_t native_next() {
+  uint8_t result;
+
+    if (!fp_begin()) return NATIVE_DECLINE;
+    ZP(0x49) = fp_a;
+    ZP(0x4A) = fp_y;
+    fp_x = register_sp - 2;                                            // TSX inside the JSR to FNDFOR
+    fp_fndfor();
+    if (fp_nz!=0 || fp_x==0) return NATIVE_DECLINE;                    // The ROM stores $49/$4A again
+
+    fp_next_step();
+    result = fp_end();
+    if (result==NATIVE_JUMP) return result;                            // Overflow
+    register_pc = fp_next_pc;
+    return NATIVE_JUMP;
+}
+
+
+void basic_loops_register_traps() {
+    native_trap_register(0xA38A, NATIVE_TRAP_BASIC, native_fndfor);
+    native_trap_register(0xAD27, NATIVE_TRAP_BASIC, native_next);
+    return;
+}
+
+#endif // ENABLE_ACCELERATION
+
+#endif // BASIC_LOOPS_H
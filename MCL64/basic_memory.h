@@ -0,0 +1,124 @@
+// ============================================================================
+// MCL64 - Native BASIC Block Move
+// ----------------------------------------------------------------------------
+// BLTU ($A3BF) moves the block $5F/$60 up to $5A/$5B so that it ends at
+// $58/$59, copying a byte at a time from the top down.  BASIC uses it to
+// open a gap for an inserted line, to make room for new variables and
+// arrays, and in garbage collection.  REASON ($A3B8) checks for room and
+// stays with the ROM.
+//
+// When both blocks are in RAM below $8000 or at $C000-$CFFF, and every
+// 128-byte block of them is held in internal memory without write-through,
+// the move is a memmove() on internal_RAM, and the line and variable
+// indexes are told of the bytes written.  Other moves are copied with
+// read_byte() and write_byte(), which post the writes to the motherboard
+// where the page policy asks for it.  A move down onto itself is copied
+// top down as the ROM does.
+//
+// $22, $58-$5B and the registers and flags are left as BLTU leaves them.
+// A block ending below its start would wrap through the whole memory and
+// is left to the ROM.
+// ============================================================================
+
+#ifndef BASIC_MEMORY_H
+#define BASIC_MEMORY_H
+
+#if ENABLE_ACCELERATION
+
+// -------------------------------------------------
+// Can start to end-1 be moved in internal_RAM directly?
+// -------------------------------------------------
+uint8_t bltu_internal(uint16_t start, uint32_t end) {
+  uint32_t block;
+
+    if (start==end) return 1;
+    if (start<0x0200 || end>0xD000 || (start<0xC000 && end>0x8000)) return 0;   // Zero page, stack and the banked areas
+    for (block=start>>7; block<=((end-1)>>7); block++) {
+      if (internal_address_check(block<<7)<=0x2) return 0;
+    }
+    return 1;
+}
+
+
+// -------------------------------------------------
+// $A3BF - BLTU
+// -------------------------------------------------
+uint8_t native_bltu() {
+  uint16_t source;
+  uint16_t source_end;
+  uint16_t destination;
+  uint16_t destination_end;
+  uint16_t length;
+  uint16_t offset;
+  uint8_t  length_low;
+  uint8_t  data=0x0;
+  uint8_t  result;
+
+    if ((register_flags&0x08) || !native_zero_page_begin()) return NATIVE_DECLINE;
+
+    source          = internal_RAM[0x5F] | (internal_RAM[0x60]<<8);
+    source_end      = internal_RAM[0x5A] | (internal_RAM[0x5B]<<8);
+    destination_end = internal_RAM[0x58] | (internal_RAM[0x59]<<8);
+    if (source_end<source) return NATIVE_DECLINE;
+
+    length      = source_end - source;
+    length_low  = length;
+    destination = destination_end - length;
+
+    if ((uint32_t)destination + length <= 0x10000 && bltu_internal(source, (uint32_t)source+length) && bltu_internal(destination, (uint32_t)destination+length)) {
+      if (length!=0) {
+        if (destination>=source || destination+length<=source) {
+          data = internal_RAM[source];
+          memmove(&internal_RAM[destination], &internal_RAM[source], length);
+        }
+        else {
+          for (offset=length; offset>0; offset--) {
+            data = internal_RAM[source+offset-1];
+            internal_RAM[destination+offset-1] = data;
+          }
+        }
+        line_index_write_range(destination, (uint32_t)destination+length);
+        var_index_write_range(destination, (uint32_t)destination+length);
+      }
+    }
+    else {
+      for (offset=length; offset>0; offset--) {
+        data = read_byte((uint16_t)(source+offset-1));
+        write_byte((uint16_t)(destination+offset-1), data);
+      }
+    }
+
+    internal_RAM[0x22] = length_low;
+    internal_RAM[0x5A] = source;                                       // Both pointers end a page below the blocks
+    internal_RAM[0x5B] = (source>>8) - 1;
+    internal_RAM[0x58] = destination;
+    internal_RAM[0x59] = (destination>>8) - 1;
+
+    register_flags &= 0x3C;
+    if (length_low!=0) {                                               // Flags of the SBC of the low byte from $58
+      result = destination_end - length_low;
+      register_flags |= ((destination_end&0xFF)>=length_low);
+      register_flags |= ((((destination_end&0xFF) ^ length_low) & ((destination_end&0xFF) ^ result) & 0x80)!=0) << 6;
+    }
+    else {                                                             // Flags of the SBC of the high bytes
+      result = (source_end>>8) - (source>>8);
+      register_flags |= 0x01;
+      register_flags |= ((((source_end>>8) ^ (source>>8)) & ((source_end>>8) ^ result) & 0x80)!=0) << 6;
+    }
+    register_flags |= 0x02;                                            // DEX to 0
+    register_a = (length!=0) ? data : 0x0;
+    register_x = 0x0;
+    register_y = 0x0;
+    native_zero_page_end();
+    return NATIVE_RTS;
+}
+
+
+void basic_memory_register_traps() {
+    native_trap_register(0xA3BF, NATIVE_TRAP_BASIC, native_bltu);
+    return;
+}
+
+#endif // ENABLE_ACCELERATION
+
+#endif // BASIC_MEMORY_H
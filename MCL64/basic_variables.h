@@ -0,0 +1,271 @@
+// ============================================================================
+// MCL64 - BASIC Variable Index
+// ----------------------------------------------------------------------------
+// PTRGET ($B08B) parses a variable name and then walks the simple
+// variables from VARTAB to ARYTAB seven bytes at a time ($B0E7), or the
+// arrays from ARYTAB to STREND by their sizes ($B218).  Traps at these two
+// search loops look the name up in hash tables instead, keyed by the two
+// name bytes in $45/$46, which carry the type in their top bits.  The
+// name parsing, creation of new variables and DIM stay with the ROM.
+//
+// The tables are built from the variable area on first use and dropped
+// by write_byte() when VARTAB, ARYTAB or STREND ($2D-$32) change, or when
+// a byte the walk compares is written: the names of the simple variables
+// and the names and sizes of the arrays, marked in var_index_watched.
+// Writes to variable values do not drop them.  Areas that the ROM walk
+// would not finish, or with more than VAR_INDEX_MAX entries, are left to
+// the ROM.
+//
+// The traps leave $5F/$60, $47/$48, A, X, Y and the flags as the ROM loop
+// does, continuing at its found or not found address.
+// ============================================================================
+
+#ifndef BASIC_VARIABLES_H
+#define BASIC_VARIABLES_H
+
+#if ENABLE_ACCELERATION
+
+#define VAR_INDEX_MAX       1024
+#define VAR_INDEX_SLOTS     2048      // Power of two, at most half used
+#define VAR_INDEX_NONE      0xFFFF
+
+#define VAR_INDEX_EMPTY     0x0
+#define VAR_INDEX_VALID     0x1
+#define VAR_INDEX_UNUSABLE  0x2
+
+struct var_index_entry {
+  uint16_t  name;                     // $45 | $46<<8
+  uint16_t  address;                  // VAR_INDEX_NONE for a free slot
+  uint8_t   overflow;                 // V flag left by the walk when it reaches this entry, 0xFF unchanged
+};
+
+var_index_entry var_index_simple[VAR_INDEX_SLOTS];
+var_index_entry var_index_array[VAR_INDEX_SLOTS];
+uint32_t  var_index_watched[0x10000/32];  // Bytes the walks compare
+uint8_t   var_index_state=VAR_INDEX_EMPTY;
+uint8_t   var_index_simple_overflow;  // V flag after the walks end without a match
+uint8_t   var_index_array_overflow;
+uint8_t   var_index_array_count;
+
+uint16_t  var_index_watch_start=0;
+uint16_t  var_index_watch_end=0;      // 0 when there is nothing to watch
+
+
+// -------------------------------------------------
+// Called by write_byte() for addresses below var_index_watch_end
+// -------------------------------------------------
+inline void var_index_write(uint16_t local_address) {
+    if ((local_address>=0x2D && local_address<=0x32) ||
+        (local_address>=var_index_watch_start && (var_index_watched[local_address>>5] & ((uint32_t)1 << (local_address&0x1F))))) {
+      var_index_state     = VAR_INDEX_EMPTY;
+      var_index_watch_end = 0;
+    }
+    return;
+}
+
+// For memory written without write_byte(), start to end-1
+inline void var_index_write_range(uint16_t start, uint32_t end) {
+    if ((start<var_index_watch_end && end>var_index_watch_start) || (start<=0x32 && end>0x2D)) {
+      var_index_state     = VAR_INDEX_EMPTY;
+      var_index_watch_end = 0;
+    }
+    return;
+}
+
+
+// -------------------------------------------------
+// Hash tables
+// -------------------------------------------------
+inline uint16_t var_index_hash(uint16_t name) {
+    return ((uint16_t)(name*0x9E37) >> 5) & (VAR_INDEX_SLOTS-1);
+}
+
+inline void var_index_watch(uint16_t address) {
+    var_index_watched[address>>5] |= ((uint32_t)1 << (address&0x1F));
+    return;
+}
+
+// The first entry of a name is the one the ROM walk finds
+void var_index_insert(var_index_entry *table, uint16_t name, uint16_t address, uint8_t overflow) {
+  uint16_t slot = var_index_hash(name);
+
+    while (table[slot].address!=VAR_INDEX_NONE) {
+      if (table[slot].name==name) return;
+      slot = (slot+1) & (VAR_INDEX_SLOTS-1);
+    }
+    table[slot].name     = name;
+    table[slot].address  = address;
+    table[slot].overflow = overflow;
+    return;
+}
+
+var_index_entry *var_index_lookup(var_index_entry *table, uint16_t name) {
+  uint16_t slot = var_index_hash(name);
+
+    while (table[slot].address!=VAR_INDEX_NONE) {
+      if (table[slot].name==name) return &table[slot];
+      slot = (slot+1) & (VAR_INDEX_SLOTS-1);
+    }
+    return 0;
+}
+
+
+// -------------------------------------------------
+// Walk the variable area as the ROM loops do
+//  Return: 0 when a walk would not end at ARYTAB or STREND
+// -------------------------------------------------
+uint8_t var_index_walk() {
+  uint16_t vartab = internal_RAM[0x2D] | (internal_RAM[0x2E]<<8);
+  uint16_t arytab = internal_RAM[0x2F] | (internal_RAM[0x30]<<8);
+  uint16_t strend = internal_RAM[0x31] | (internal_RAM[0x32]<<8);
+  uint16_t address;
+  uint16_t count=0;
+  uint32_t next;
+  uint8_t  overflow;
+
+    if (arytab<vartab || strend<arytab || (arytab-vartab)%7!=0) return 0;
+
+    overflow = 0xFF;                                                   // V is unchanged until the walk steps
+    for (address=vartab; address!=arytab; address+=7) {
+      if (++count>VAR_INDEX_MAX) return 0;
+      var_index_insert(var_index_simple, read_byte(address) | (read_byte(address+1)<<8), address, overflow);
+      var_index_watch(address);
+      var_index_watch(address+1);
+      overflow = ((address&0xFF)>=0x79 && (address&0xFF)<=0x7F);       // ADC #$07 to the low byte
+    }
+    var_index_simple_overflow = overflow;
+
+    count = 0;
+    overflow = 0xFF;
+    for (address=arytab; address!=strend; address=next) {
+      if (++count>VAR_INDEX_MAX || address>0xFFFC) return 0;
+      var_index_insert(var_index_array, read_byte(address) | (read_byte(address+1)<<8), address, overflow);
+      var_index_watch(address);
+      var_index_watch(address+1);
+      var_index_watch(address+2);
+      var_index_watch(address+3);
+
+      next = (uint32_t)address + (read_byte(address+2) | (read_byte(address+3)<<8));
+      if (next==address || next>strend) return 0;                       // The ROM walk would not stop at STREND
+      overflow = ((~((address>>8) ^ read_byte(address+3)) & ((address>>8) ^ (next>>8)) & 0x80)!=0);
+    }
+    var_index_array_overflow = overflow;
+    var_index_array_count    = (count!=0);
+
+    var_index_watch_start = vartab;
+    var_index_watch_end   = strend;
+    return 1;
+}
+
+void var_index_build() {
+  uint16_t slot;
+
+    for (slot=0; slot<VAR_INDEX_SLOTS; slot++) {
+      var_index_simple[slot].address = VAR_INDEX_NONE;
+      var_index_array[slot].address  = VAR_INDEX_NONE;
+    }
+    memset(var_index_watched, 0, sizeof(var_index_watched));
+
+    var_index_state = var_index_walk() ? VAR_INDEX_VALID : VAR_INDEX_UNUSABLE;
+    if (var_index_watch_end<=0x32) var_index_watch_end = 0x33;         // Watch $2D-$32 even when the walk failed
+    return;
+}
+
+
+inline void var_index_set_overflow(uint8_t overflow) {
+    if (overflow!=0xFF) register_flags = (register_flags & 0xBF) | (overflow<<6);
+    return;
+}
+
+
+// -------------------------------------------------
+// $B0E7 - Simple variable search
+// -------------------------------------------------
+uint8_t native_ptrget_simple() {
+  var_index_entry *entry;
+  uint16_t address;
+  uint8_t  low;
+
+    if (!native_zero_page_begin()) return NATIVE_DECLINE;
+    if (var_index_state==VAR_INDEX_EMPTY) var_index_build();
+    if (var_index_state!=VAR_INDEX_VALID) return NATIVE_DECLINE;
+
+    internal_RAM[0x10] = 0x0;
+    entry = var_index_lookup(var_index_simple, internal_RAM[0x45] | (internal_RAM[0x46]<<8));
+
+    if (entry==0) {                                                    // $B11D with $5F/$60 = ARYTAB
+      internal_RAM[0x5F] = internal_RAM[0x2F];
+      internal_RAM[0x60] = internal_RAM[0x30];
+      register_a = internal_RAM[0x2F];
+      register_x = internal_RAM[0x30];
+      register_y = 0x0;
+      register_flags = (register_flags & 0x7C) | 0x03;
+      var_index_set_overflow(var_index_simple_overflow);
+      native_zero_page_end();
+      register_pc = 0xB11D;
+      return NATIVE_JUMP;
+    }
+
+    address = entry->address;                                          // $B185, $47/$48 = address of the value
+    low = address + 2;
+    internal_RAM[0x5F] = address;
+    internal_RAM[0x60] = address >> 8;
+    internal_RAM[0x47] = low;
+    internal_RAM[0x48] = (address+2) >> 8;
+    register_a = low;
+    register_x = address >> 8;
+    register_y = (address+2) >> 8;
+    register_flags = (register_flags & 0x3C) | ((register_y&0x80) | ((register_y==0) ? 0x02 : 0x00)) | (low<0x02);
+    register_flags |= ((address&0xFF)>=0x7E && (address&0xFF)<=0x7F) << 6;
+    native_zero_page_end();
+    return NATIVE_RTS;
+}
+
+
+// -------------------------------------------------
+// $B218 - Array search
+// -------------------------------------------------
+uint8_t native_ptrget_array() {
+  var_index_entry *entry;
+
+    if (!native_zero_page_begin()) return NATIVE_DECLINE;
+    if (var_index_state==VAR_INDEX_EMPTY) var_index_build();
+    if (var_index_state!=VAR_INDEX_VALID) return NATIVE_DECLINE;
+
+    entry = var_index_lookup(var_index_array, internal_RAM[0x45] | (internal_RAM[0x46]<<8));
+
+    if (entry==0) {                                                    // $B261 with $5F/$60 = STREND
+      internal_RAM[0x5F] = internal_RAM[0x31];
+      internal_RAM[0x60] = internal_RAM[0x32];
+      register_a = internal_RAM[0x32];
+      register_x = internal_RAM[0x31];
+      if (var_index_array_count) register_y = 0x3;
+      register_flags = (register_flags & 0x7C) | 0x03;
+      var_index_set_overflow(var_index_array_overflow);
+      native_zero_page_end();
+      register_pc = 0xB261;
+      return NATIVE_JUMP;
+    }
+
+    internal_RAM[0x5F] = entry->address;                               // $B24D
+    internal_RAM[0x60] = entry->address >> 8;
+    register_a = internal_RAM[0x46];
+    register_x = entry->address;
+    register_y = 0x1;
+    register_flags = (register_flags & 0x7C) | 0x03;
+    var_index_set_overflow(entry->overflow);
+    native_zero_page_end();
+    register_pc = 0xB24D;
+    return NATIVE_JUMP;
+}
+
+
+void basic_variables_register_traps() {
+    native_trap_register(0xB0E7, NATIVE_TRAP_BASIC, native_ptrget_simple);
+    native_trap_register(0xB218, NATIVE_TRAP_BASIC, native_ptrget_array);
+    return;
+}
+
+#endif // ENABLE_ACCELERATION
+
+#endif // BASIC_VARIABLES_H
@@ -0,0 +1,20 @@
+//
+// cart_images.cpp - Cartridge images (.crt) kept in flash
+// Supported hardware types: 0 normal 8K/16K, 5 Ocean, 19 Magic Desk, 32 EasyFlash
+//
+// To add a cartridge convert the .crt file to a byte array, for example
+// with "xxd -i game.crt", declare it const so it stays in flash and add
+// it to CART_IMAGES:
+//
+//   const uint8_t GAME_CRT[] = { 0x43,0x36,0x34,0x20, ... };
+//   ...
+//   { "Game", GAME_CRT, sizeof(GAME_CRT) },
+//
+
+#include "cart_images.h"
+
+const cart_image CART_IMAGES[] = {
+  { 0, 0, 0 },
+};
+
+const uint8_t CART_IMAGE_COUNT = 0;
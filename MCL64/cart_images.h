@@ -0,0 +1,21 @@
+//
+// cart_images.h - Cartridge images (.crt) kept in flash
+// Selected with the 'C' UART command and served by cartridge.h
+//
+
+#ifndef CART_IMAGES_H
+#define CART_IMAGES_H
+
+#include <stdint.h>
+
+struct cart_image {
+  const char     *name;
+  const uint8_t  *crt;              // Complete .crt file, header and CHIP packets
+  uint32_t        length;
+};
+
+// Cartridge image table
+extern const cart_image CART_IMAGES[];
+extern const uint8_t    CART_IMAGE_COUNT;
+
+#endif // CART_IMAGES_H
@@ -0,0 +1,349 @@
+// ============================================================================
+// MCL64 - Cartridge ROM Shadow and Image Overlay
+// ----------------------------------------------------------------------------
+// Physical cartridges
+//  After RESET the bus is checked for the CBM80 signature at $8004.  RAM
+//  holding the signature, as left by reset protection or by a program, is
+//  told apart by writing $8004 and reading it back: a ROM still answers
+//  with the signature.  When a cartridge answers, ROML ($8000-$9FFF) is
+//  copied into internal memory, and so is ROMH ($A000-$BFFF) when $A000
+//  is still ROM with LORAM low and BASIC banked out (a 16K cartridge).
+//  The probes write to the RAM below the ROM, so the byte there is read
+//  first with LORAM and HIRAM low, where the PLA maps RAM for 8K and 16K
+//  cartridges, and written back afterwards.  A write to $DE00-$DFFF may
+//  switch the cartridge to another bank, so it drops the copy and the
+//  cartridge pages go back to bus reads until the next RESET.
+//
+// Cartridge images
+//  A .crt image from the CART_IMAGES table in flash (cart_images.cpp) can
+//  be selected with 'C<n>' over the UART.  No cartridge is plugged in, so
+//  its ROM is served from flash for every CPU read of the cartridge ranges
+//  while the bus cycle, if any, goes to the motherboard.  Bank switching
+//  for Ocean, Magic Desk and EasyFlash is done on writes to $DE00-$DFFF.
+//
+// Either way fetch_byte_from_bank() serves the ROM following EXROM, GAME,
+// LORAM and HIRAM as the PLA does.
+// ============================================================================
+
+#ifndef CARTRIDGE_H
+#define CARTRIDGE_H
+
+#if ENABLE_ACCELERATION
+
+#include "cart_images.h"
+
+#define CART_ROML   0x1
+#define CART_ROMH   0x2
+
+#define CRT_NORMAL        0
+#define CRT_OCEAN         5
+#define CRT_MAGIC_DESK    19
+#define CRT_EASYFLASH     32
+
+#define CART_BANKS        128
+
+extern uint8_t   current_p;
+extern uint8_t   read_byte_external(uint16_t local_address);
+extern void      write_byte_external(uint16_t local_address , uint8_t local_write_data);
+extern void      rebuild_page_access_map();
+extern void      reset_sequence();
+extern uint32_t  parse_serial_number(char **text, uint8_t base);
+
+uint8_t   cart_roml[0x2000];
+uint8_t   cart_romh[0x2000];
+uint8_t   cart_present=0;             // Banks of a physical cartridge found at the last RESET
+uint8_t   cart_shadow=0;              // Banks currently held in cart_roml/cart_romh
+
+const uint8_t *cart_roml_bank=0;      // ROM answering at $8000, 0 = none
+const uint8_t *cart_romh_bank=0;      // ROM answering at $A000, or at $E000 in Ultimax mode
+uint8_t   cart_exrom=0;               // EXROM and GAME as the cartridge drives them, 1 = asserted (low)
+uint8_t   cart_game=0;
+
+uint8_t   cart_overlay=0xFF;          // Selected CART_IMAGES entry, 0xFF = none
+uint16_t  cart_overlay_type=0;
+uint8_t   cart_overlay_exrom=0;       // Lines given in the .crt header
+uint8_t   cart_overlay_game=0;
+const uint8_t *cart_chip_low[CART_BANKS];
+const uint8_t *cart_chip_high[CART_BANKS];
+uint8_t   cart_bank=0;
+uint8_t   easyflash_ram[0x100];
+
+const uint8_t cart_signature[5] = { 0xC3, 0xC2, 0xCD, 0x38, 0x30 };   // "CBM80"
+
+#define CART_ROML_MAPPED     ( cart_roml_bank!=0 && ( (cart_exrom && (current_p&0x3)==0x3) || (cart_game && !cart_exrom) ) )
+#define CART_ROMH_MAPPED     ( cart_romh_bank!=0 && cart_exrom && cart_game && (current_p&0x2) )
+#define CART_ULTIMAX_MAPPED  ( cart_romh_bank!=0 && cart_game && !cart_exrom )
+
+
+// -------------------------------------------------
+// Drive LORAM, HIRAM and CHAREN to the PLA without a CPU write to $0001
+// -------------------------------------------------
+void cart_set_port(uint8_t local_p) {
+    digitalWriteFast(PIN_P0,  (local_p & 0x01) );
+    digitalWriteFast(PIN_P1,  (local_p & 0x02) >> 1 );
+    digitalWriteFast(PIN_P2,  (local_p & 0x04) >> 2 );
+    return;
+}
+
+
+// -------------------------------------------------
+// Is the address ROM with the port bits local_p?  A write to the ROM goes
+// to the RAM below it, so the RAM byte is read with all RAM mapped in
+// and written back.  Runs at RESET with the port pins high.
+// -------------------------------------------------
+uint8_t cart_is_rom(uint16_t local_address, uint8_t local_p) {
+  uint8_t ram_data;
+  uint8_t data;
+  uint8_t is_rom;
+
+    cart_set_port(0x0);                                               // LORAM and HIRAM low, RAM at $8000-$BFFF
+    ram_data = read_byte_external(local_address);
+
+    cart_set_port(local_p);
+    data = read_byte_external(local_address);
+    write_byte_external(local_address, data ^ 0xFF);
+    is_rom = (read_byte_external(local_address)==data);
+    write_byte_external(local_address, ram_data);
+
+    cart_set_port(0x7);
+    return is_rom;
+}
+
+
+// -------------------------------------------------
+// Look for a physical cartridge and copy its ROM
+// -------------------------------------------------
+void detect_cartridge() {
+  uint16_t offset;
+
+    cart_present = 0;
+    cart_shadow  = 0;
+    if (cart_overlay!=0xFF) return;                                   // An image is selected instead
+
+    cart_roml_bank = 0;
+    cart_romh_bank = 0;
+    cart_exrom = 0;
+    cart_game  = 0;
+
+    for (offset=0; offset<5; offset++) {
+      if (read_byte_external(0x8004+offset) != cart_signature[offset]) break;
+    }
+
+    if (offset==5 && cart_is_rom(0x8004, 0x7)) {
+      cart_present = CART_ROML;
+      for (offset=0; offset<0x2000; offset++) cart_roml[offset] = read_byte_external(0x8000+offset);
+
+      if (cart_is_rom(0xA000, 0x6)) {                                  // ROMH stays mapped with LORAM low (GAME asserted)
+        cart_present = CART_ROML | CART_ROMH;
+        for (offset=0; offset<0x2000; offset++) cart_romh[offset] = read_byte_external(0xA000+offset);
+      }
+      cart_shadow    = cart_present;
+      cart_exrom     = 1;
+      cart_roml_bank = cart_roml;
+      if (cart_present & CART_ROMH) {
+        cart_game      = 1;
+        cart_romh_bank = cart_romh;
+      }
+    }
+    rebuild_page_access_map();
+    return;
+}
+
+
+// -------------------------------------------------
+// Page map rules
+//  Return: 0 when the page must use the bus, 1 when it must at least read
+//          internal memory, 0xFF for no change
+// -------------------------------------------------
+inline uint8_t cart_page_access(uint8_t page) {
+    if (cart_overlay!=0xFF) {
+      if ((page>=0x80 && page<=0xBF) || page>=0xE0) return 0x1;       // The motherboard does not have the ROM
+      return 0xFF;
+    }
+    if (page>=0x80 && page<=0x9F && ((cart_present & ~cart_shadow) & CART_ROML)) return 0x0;
+    if (page>=0xA0 && page<=0xBF && ((cart_present & ~cart_shadow) & CART_ROMH)) return 0x0;
+    return 0xFF;
+}
+
+
+// -------------------------------------------------
+// Image overlay banking
+// -------------------------------------------------
+void cart_select_bank(uint8_t bank) {
+    cart_bank      = bank & (CART_BANKS-1);
+    cart_roml_bank = cart_chip_low[cart_bank];
+    cart_romh_bank = cart_chip_high[cart_bank];
+    return;
+}
+
+void cart_overlay_reset() {
+    if (cart_overlay==0xFF) return;
+    cart_exrom = cart_overlay_exrom;
+    cart_game  = cart_overlay_game;
+    if (cart_overlay_type==CRT_EASYFLASH) {                           // Boot jumper: Ultimax with bank 0
+      cart_exrom = 0;
+      cart_game  = 1;
+    }
+    cart_select_bank(0);
+    return;
+}
+
+inline uint32_t crt_word32(const uint8_t *data) {
+    return ((uint32_t)data[0]<<24) | ((uint32_t)data[1]<<16) | ((uint32_t)data[2]<<8) | data[3];
+}
+
+inline uint16_t crt_word16(const uint8_t *data) {
+    return (data[0]<<8) | data[1];
+}
+
+// Parse a .crt image into the chip tables
+//  Return: 1 when the image can be served
+uint8_t cart_overlay_load(uint8_t image) {
+  const uint8_t *crt    = CART_IMAGES[image].crt;
+  uint32_t       length = CART_IMAGES[image].length;
+  uint32_t       offset;
+  uint16_t       bank, load_address, size;
+
+    if (length<0x40 || memcmp(crt, "C64 CARTRIDGE   ", 16)!=0) return 0;
+
+    cart_overlay_type = crt_word16(&crt[0x16]);
+    if (cart_overlay_type!=CRT_NORMAL && cart_overlay_type!=CRT_OCEAN && cart_overlay_type!=CRT_MAGIC_DESK && cart_overlay_type!=CRT_EASYFLASH) return 0;
+    cart_overlay_exrom = (crt[0x18]==0);
+    cart_overlay_game  = (crt[0x19]==0);
+    if (cart_overlay_type==CRT_MAGIC_DESK) {                          // 8K mode, the header is often wrong
+      cart_overlay_exrom = 1;
+      cart_overlay_game  = 0;
+    }
+
+    memset(cart_chip_low,  0, sizeof(cart_chip_low));
+    memset(cart_chip_high, 0, sizeof(cart_chip_high));
+
+    offset = crt_word32(&crt[0x10]);
+    while (offset+0x10 <= length && memcmp(&crt[offset], "CHIP", 4)==0) {
+      bank         = crt_word16(&crt[offset+0x0A]) & (CART_BANKS-1);
+      load_address = crt_word16(&crt[offset+0x0C]);
+      size         = crt_word16(&crt[offset+0x0E]);
+      if (offset+0x10+size > length || crt_word32(&crt[offset+0x04]) < 0x10) break;
+
+      if (cart_overlay_type==CRT_OCEAN) {                             // Banks are numbered through both ranges, ROMH mirrors ROML
+        cart_chip_low[bank]  = &crt[offset+0x10];
+        cart_chip_high[bank] = &crt[offset+0x10];
+      }
+      else if (load_address==0x8000) {
+        cart_chip_low[bank] = &crt[offset+0x10];
+        if (size==0x4000) cart_chip_high[bank] = &crt[offset+0x10+0x2000];
+      }
+      else cart_chip_high[bank] = &crt[offset+0x10];                  // $A000 or Ultimax $E000
+
+      offset += crt_word32(&crt[offset+0x04]);
+    }
+    return 1;
+}
+
+
+// -------------------------------------------------
+// Called for writes to I/O1 and I/O2
+// -------------------------------------------------
+inline void cart_io_write(uint16_t local_address , uint8_t local_write_data) {
+
+    if ((current_p&0x4)==0 || (current_p&0x3)==0) return;              // I/O not mapped in
+
+    if (cart_overlay==0xFF) {
+      if (cart_shadow==0) return;
+      cart_shadow    = 0;
+      cart_roml_bank = 0;
+      cart_romh_bank = 0;
+      rebuild_page_access_map();
+      return;
+    }
+
+    switch (cart_overlay_type) {
+      case CRT_OCEAN:
+        if ((local_address&0xFF00)==0xDE00) cart_select_bank(local_write_data & 0x3F);
+        break;
+
+      case CRT_MAGIC_DESK:
+        if ((local_address&0xFF00)==0xDE00) {
+          cart_select_bank(local_write_data & 0x7F);
+          cart_exrom = ((local_write_data&0x80)==0);                    // Bit 7 switches the cartridge out
+        }
+        break;
+
+      case CRT_EASYFLASH:
+        if ((local_address&0xFF00)==0xDF00) easyflash_ram[local_address&0xFF] = local_write_data;
+        else if ((local_address&0x2)==0) cart_select_bank(local_write_data & 0x3F);
+        else {
+          cart_exrom = (local_write_data>>1) & 0x1;
+          cart_game  = (local_write_data&0x4) ? (local_write_data&0x1) : 1;  // Without the M bit GAME follows the boot jumper
+        }
+        break;
+    }
+    return;
+}
+
+
+// -------------------------------------------------
+// I/O2 ($DF00-$DFFF) is the EasyFlash RAM while an EasyFlash image is
+// selected, so other devices there (the REU) are switched off
+// -------------------------------------------------
+inline uint8_t cart_io2_claimed() {
+    return (cart_overlay!=0xFF && cart_overlay_type==CRT_EASYFLASH);
+}
+
+
+// -------------------------------------------------
+// Reads of I/O1 and I/O2 answered by an image
+//  Return: 1 with the data in *local_data
+// -------------------------------------------------
+inline uint8_t cart_io_read(uint16_t local_address , uint8_t *local_data) {
+    if (!cart_io2_claimed() || (local_address&0xFF00)!=0xDF00) return 0;
+    if ((current_p&0x4)==0 || (current_p&0x3)==0) return 0;
+    *local_data = easyflash_ram[local_address&0xFF];
+    return 1;
+}
+
+
+// -------------------------------------------------
+// UART command
+//  C      - Report the physical cartridge (CP0 none, CP1 8K, CP3 16K) and list the images
+//  C<n>   - Serve image n and restart the CPU
+//  CX     - Remove the image and restart the CPU
+// -------------------------------------------------
+void process_cartridge_command(char *text) {
+  uint8_t image;
+
+    if (*text==0) {
+      Serial.print("CP");  Serial.println(cart_present);
+      for (image=0; image<CART_IMAGE_COUNT; image++) {
+        Serial.print("C");  Serial.print(image);
+        Serial.print(" ");  Serial.println(CART_IMAGES[image].name);
+      }
+      return;
+    }
+
+    if (*text=='X' || *text=='x') {
+      cart_overlay   = 0xFF;
+      cart_roml_bank = 0;
+      cart_romh_bank = 0;
+      cart_exrom = 0;
+      cart_game  = 0;
+      Serial.println("CX");
+    }
+    else {
+      image = parse_serial_number(&text, 10);
+      if (image>=CART_IMAGE_COUNT || cart_overlay_load(image)==0) {
+        Serial.println("?");
+        return;
+      }
+      cart_overlay = image;
+      Serial.print("C");  Serial.println(image);
+    }
+    cart_overlay_reset();
+    rebuild_page_access_map();
+    reset_sequence();
+    return;
+}
+
+#endif // ENABLE_ACCELERATION
+
+#endif // CARTRIDGE_H
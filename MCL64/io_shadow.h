@@ -0,0 +1,160 @@
+// ============================================================================
+// MCL64 - VIC, SID and Color RAM Shadows
+// ----------------------------------------------------------------------------
+// Writes to the VIC ($D000-$D3FF, 64-byte mirrors), SID ($D400-$D7FF,
+// 32-byte mirrors) and color RAM ($D800-$DBFF) pass through to the
+// motherboard as before and are also kept here.  In the accelerated modes
+// reads of registers that only change when the CPU writes them are
+// answered from the shadow without a bus cycle.
+//
+// Always read from the bus:
+//  VIC  $D011 (raster bit 8), $D012, $D013/$D014 (light pen), $D019,
+//       $D01E/$D01F (collisions, cleared by the read)
+//  SID  $D419-$D41C (paddles, oscillator 3, envelope 3)
+//
+// A register is served only once its value is known, from a CPU write or
+// from an earlier bus read.  The SID write-only registers return the last
+// byte written to the SID, which is what stays on its data bus.
+//
+// Color RAM is 4 bits wide.  The upper nibble of a color RAM read is
+// whatever was left on the data bus, so shadowed reads take it from the
+// last byte sampled from the bus.
+//
+// CIA timer reads are passed to virtual_cia.h.
+// ============================================================================
+
+#ifndef IO_SHADOW_H
+#define IO_SHADOW_H
+
+#if ENABLE_ACCELERATION
+
+extern uint8_t   current_p;
+extern uint8_t   direct_datain;
+
+#define IO_MAPPED_IN  ( ((current_p&0x4)!=0) && ((current_p&0x3)!=0) )
+
+uint8_t   vic_shadow[0x40];
+uint8_t   vic_shadow_valid[0x40];
+uint8_t   sid_last_write=0;
+uint8_t   sid_shadow_valid=0;           // Set once the SID has been written since reset
+uint8_t   color_ram_shadow[0x400];      // Low nibble of each color RAM location
+uint8_t   color_ram_valid[0x80];        // One bit per location
+
+// Bits that read back as 1 for each VIC register
+const uint8_t vic_unused_bits[0x40] = {
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,   // $D000 sprite positions
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xC0, 0x00, 0x01, 0x70, 0xF0, 0x00, 0x00, 0x00, 0x00, 0x00,   // $D010 control
+  0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xF0, 0xFF,   // $D020 colors
+  0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,   // $D030 unused
+};
+
+
+// -------------------------------------------------
+// Registers whose value changes without a CPU write
+// -------------------------------------------------
+inline uint8_t vic_register_volatile(uint8_t reg) {
+  return (reg==0x11 || reg==0x12 || reg==0x13 || reg==0x14 || reg==0x19 || reg==0x1E || reg==0x1F);
+}
+
+inline uint8_t sid_register_volatile(uint8_t reg) {
+  return (reg>=0x19 && reg<=0x1C);
+}
+
+
+// -------------------------------------------------
+// Record a CPU write to an I/O register
+// -------------------------------------------------
+inline void io_shadow_write(uint16_t local_address , uint8_t local_write_data) {
+  uint8_t reg;
+
+    if (!IO_MAPPED_IN) return;
+
+    if ((local_address&0xFC00)==0xD000) {
+      reg = local_address & 0x3F;
+      vic_shadow[reg]       = local_write_data | vic_unused_bits[reg];
+      vic_shadow_valid[reg] = 1;
+    }
+    else if ((local_address&0xFC00)==0xD400) {
+      sid_last_write   = local_write_data;
+      sid_shadow_valid = 1;
+    }
+    else if ((local_address&0xFC00)==0xD800) {
+      local_address &= 0x3FF;
+      color_ram_shadow[local_address]    = local_write_data & 0x0F;
+      color_ram_valid[local_address>>3] |= (1 << (local_address&0x7));
+    }
+    else if ((local_address&0xFE00)==0xDC00) {
+      virtual_cia_write(local_address, local_write_data);
+    }
+    return;
+}
+
+
+// -------------------------------------------------
+// Fill a stable VIC register or color RAM from a bus read
+// -------------------------------------------------
+inline void io_shadow_fill(uint16_t local_address , uint8_t local_data) {
+  uint8_t reg;
+
+    if (!IO_MAPPED_IN) return;
+
+    if ((local_address&0xFC00)==0xD000) {
+      reg = local_address & 0x3F;
+      if (vic_register_volatile(reg)) return;
+      vic_shadow[reg]       = local_data;
+      vic_shadow_valid[reg] = 1;
+    }
+    else if ((local_address&0xFC00)==0xD800) {
+      local_address &= 0x3FF;
+      color_ram_shadow[local_address]    = local_data & 0x0F;
+      color_ram_valid[local_address>>3] |= (1 << (local_address&0x7));
+    }
+    return;
+}
+
+
+// -------------------------------------------------
+// Serve a read from the shadows
+//  Return: 1 with the data in *local_data, 0 when the bus must be read
+// -------------------------------------------------
+inline uint8_t io_shadow_read(uint16_t local_address , uint8_t *local_data) {
+  uint8_t reg;
+
+    if (!IO_MAPPED_IN) return 0;
+
+    if ((local_address&0xFC00)==0xD000) {
+      reg = local_address & 0x3F;
+      if (vic_shadow_valid[reg]==0 || vic_register_volatile(reg)) return 0;
+      *local_data = vic_shadow[reg];
+      return 1;
+    }
+    if ((local_address&0xFC00)==0xD400) {
+      reg = local_address & 0x1F;
+      if (sid_shadow_valid==0 || sid_register_volatile(reg)) return 0;
+      *local_data = sid_last_write;
+      return 1;
+    }
+    if ((local_address&0xFC00)==0xD800) {
+      local_address &= 0x3FF;
+      if ((color_ram_valid[local_address>>3] & (1 << (local_address&0x7)))==0) return 0;
+      *local_data = (direct_datain & 0xF0) | color_ram_shadow[local_address];
+      return 1;
+    }
+    if ((local_address&0xFE00)==0xDC00) return virtual_cia_read(local_address, local_data);
+    return 0;
+}
+
+
+// -------------------------------------------------
+// Forget the shadows on reset
+// -------------------------------------------------
+void io_shadow_reset() {
+    memset(vic_shadow_valid, 0, sizeof(vic_shadow_valid));
+    sid_shadow_valid = 0;
+    memset(color_ram_valid, 0, sizeof(color_ram_valid));
+    return;
+}
+
+#endif // ENABLE_ACCELERATION
+
+#endif // IO_SHADOW_H
@@ -0,0 +1,182 @@
+// ============================================================================
+// MCL64 - Native Routine Traps
+// ----------------------------------------------------------------------------
+// A trap replaces the 6502 routine at an address with a C++ handler.  At
+// each opcode fetch the page of the PC is tested in a 256-bit bitmap, so
+// the cost for code without traps is one bit test.  A trap only fires when
+// the fetch is served from internal memory (modes 2-4, not while a timing
+// or PC policy fallback is in effect) and the bank it was registered for
+// is mapped in, so a RAM routine never runs a BASIC or KERNAL handler and
+// a cartridge or LORAM/HIRAM change disables ROM traps.
+//
+// Handlers have the CPU registers and memory through read_byte() and
+// write_byte() and return:
+//  NATIVE_RTS      - the routine is complete, return as its RTS would
+//  NATIVE_JUMP     - continue at register_pc, set by the handler
+//  NATIVE_DECLINE  - run the 6502 code, e.g. for a case not handled natively
+//
+// Handlers that work on the zero page in internal_RAM directly bracket
+// the work with native_zero_page_begin() and native_zero_page_end(), which
+// post the bytes that changed when the zero page is write-through.
+//
+// Traps are registered in native_traps_init() and are off after power-up
+// until 'N1' switches them on; 'N0' switches them off again.
+// ============================================================================
+
+#ifndef NATIVE_TRAPS_H
+#define NATIVE_TRAPS_H
+
+#if ENABLE_ACCELERATION
+
+#define NATIVE_TRAPS_MAX    48
+
+#define NATIVE_TRAP_RAM     0x0
+#define NATIVE_TRAP_BASIC   0x1
+#define NATIVE_TRAP_KERNAL  0x2
+#define NATIVE_TRAP_ROMS    0x3       // Routine calls across BASIC and KERNAL
+
+#define NATIVE_DECLINE      0x0
+#define NATIVE_RTS          0x1
+#define NATIVE_JUMP         0x2
+
+extern uint8_t   internal_address_check(uint16_t local_address);
+extern void      basic_float_register_traps();
+extern void      basic_functions_register_traps();
+extern void      basic_convert_register_traps();
+extern void      basic_lines_register_traps();
+extern void      basic_variables_register_traps();
+extern void      basic_garbage_register_traps();
+extern void      basic_loops_register_traps();
+extern void      basic_memory_register_traps();
+extern void      basic_chrget_register_traps();
+
+struct native_trap {
+  uint16_t  address;
+  uint8_t   bank;
+  uint8_t   (*handler)();
+};
+
+native_trap native_trap_table[NATIVE_TRAPS_MAX];
+uint8_t   native_trap_count=0;
+uint32_t  native_trap_pages[8];       // One bit per 256-byte page with a trap
+uint8_t   native_traps_enabled=0;     // Off until enabled with 'N1'
+uint32_t  native_trap_hits=0;
+
+uint8_t   native_zero_page[0x100];    // Zero page when a write-through handler started
+uint8_t   native_zero_page_through=0;
+
+
+// -------------------------------------------------
+// Register a handler
+// -------------------------------------------------
+void native_trap_register(uint16_t address, uint8_t bank, uint8_t (*handler)()) {
+
+    if (native_trap_count==NATIVE_TRAPS_MAX) return;
+    native_trap_table[native_trap_count].address = address;
+    native_trap_table[native_trap_count].bank    = bank;
+    native_trap_table[native_trap_count].handler = handler;
+    native_trap_count++;
+    native_trap_pages[address>>13] |= ((uint32_t)1 << ((address>>8)&0x1F));
+    return;
+}
+
+
+// -------------------------------------------------
+// Is the bank the trap was registered for mapped at its address?
+// -------------------------------------------------
+inline uint8_t native_trap_bank_mapped(uint16_t address, uint8_t bank) {
+  uint8_t basic_mapped  = ((current_p&0x3)==0x3) && !CART_ROMH_MAPPED;
+  uint8_t kernal_mapped = ((current_p&0x2)==0x2) && !CART_ULTIMAX_MAPPED;
+
+    switch (bank) {
+      case NATIVE_TRAP_BASIC:   return (address>=0xA000 && address<=0xBFFF && basic_mapped);
+      case NATIVE_TRAP_KERNAL:  return (address>=0xE000 && kernal_mapped);
+      case NATIVE_TRAP_ROMS:    return (basic_mapped && kernal_mapped);
+      default:
+        if (address>=0x8000 && address<=0x9FFF) return !CART_ROML_MAPPED;
+        if (address>=0xA000 && address<=0xBFFF) return !basic_mapped && !CART_ROMH_MAPPED;
+        if (address>=0xD000 && address<=0xDFFF) return 0;
+        if (address>=0xE000)                    return !kernal_mapped && !CART_ULTIMAX_MAPPED;
+        return 1;
+    }
+}
+
+
+// -------------------------------------------------
+// Zero page access for handlers
+//  Return: 0 when the zero page is not held in internal memory
+// -------------------------------------------------
+inline uint8_t native_zero_page_begin() {
+    if (internal_address_check(0x0002)<=0x1 || internal_address_check(0x0080)<=0x1) return 0;
+
+    native_zero_page_through = (internal_address_check(0x0002)==0x2 || internal_address_check(0x0080)==0x2);
+    if (native_zero_page_through) memcpy(native_zero_page, internal_RAM, 0x100);
+    return 1;
+}
+
+inline void native_zero_page_end() {
+  uint16_t address;
+
+    if (native_zero_page_through==0) return;
+    for (address=0x2; address<0x100; address++) {
+      if (internal_RAM[address]!=native_zero_page[address]) write_byte(address, internal_RAM[address]);
+    }
+    return;
+}
+
+
+// -------------------------------------------------
+// Called at opcode fetch
+//  Return: 1 when a handler ran and the fetch was reissued at the new PC
+// -------------------------------------------------
+inline uint8_t native_trap_check(uint16_t local_pc) {
+  uint8_t i;
+  uint8_t result;
+  uint16_t return_address;
+
+    if ((native_trap_pages[local_pc>>13] & ((uint32_t)1 << ((local_pc>>8)&0x1F)))==0) return 0;
+    if (native_traps_enabled==0 || internal_address_check(local_pc)<=0x1) return 0;
+
+    for (i=0; i<native_trap_count; i++) {
+      if (native_trap_table[i].address!=local_pc) continue;
+      if (!native_trap_bank_mapped(local_pc, native_trap_table[i].bank)) continue;
+
+      result = native_trap_table[i].handler();
+      if (result==NATIVE_DECLINE) continue;
+
+      native_trap_hits++;
+      if (result==NATIVE_RTS) {
+        return_address  = pop();
+        return_address |= pop()<<8;
+        register_pc = return_address + 1;
+      }
+      assert_sync=1;
+      start_read(register_pc);
+      return 1;
+    }
+    return 0;
+}
+
+
+// -------------------------------------------------
+// Handlers are added here by the native routine modules
+// -------------------------------------------------
+void native_traps_init() {
+    native_trap_count = 0;
+    memset(native_trap_pages, 0, sizeof(native_trap_pages));
+
+    basic_float_register_traps();
+    basic_functions_register_traps();
+    basic_convert_register_traps();
+    basic_lines_register_traps();
+    basic_variables_register_traps();
+    basic_garbage_register_traps();
+    basic_loops_register_traps();
+    basic_memory_register_traps();
+    basic_chrget_register_traps();
+    return;
+}
+
+#endif // ENABLE_ACCELERATION
+
+#endif // NATIVE_TRAPS_H
@@ -72,7 +72,7 @@ extern void Write_Absolute_Y(uint8_t);
 extern void Write_Indexed_Indirect_X(uint8_t);
 extern void Write_Indexed_Indirect_Y(uint8_t);
 
-extern void Double_WriteBack(uint8_t);
+extern void Double_WriteBack(uint8_t (*)(uint8_t));
 
 
 // Opcode function declarations
@@ -1308,22 +1308,26 @@ uint8_t Calculate_ASL(uint8_t local_data) {
 // ASL - Read-modify-write Operations
 // -------------------------------------------------
 void opcode_0x06() {
-  Double_WriteBack(Calculate_ASL(Fetch_ZeroPage()));
+  Fetch_ZeroPage();
+  Double_WriteBack(Calculate_ASL);
   Begin_Fetch_Next_Opcode();
   return;
 }  // 0x06 - ASL  - Arithmetic Shift Left - ZeroPage
 void opcode_0x16() {
-  Double_WriteBack(Calculate_ASL(Fetch_ZeroPage_X()));
+  Fetch_ZeroPage_X();
+  Double_WriteBack(Calculate_ASL);
   Begin_Fetch_Next_Opcode();
   return;
 }  // 0x16 - ASL  - Arithmetic Shift Left - ZeroPage , X
 void opcode_0x0E() {
-  Double_WriteBack(Calculate_ASL(Fetch_Absolute()));
+  Fetch_Absolute();
+  Double_WriteBack(Calculate_ASL);
   Begin_Fetch_Next_Opcode();
   return;
 }  // 0x0E - ASL  - Arithmetic Shift Left - Absolute
 void opcode_0x1E() {
-  Double_WriteBack(Calculate_ASL(Fetch_Absolute_X(0)));
+  Fetch_Absolute_X(0);
+  Double_WriteBack(Calculate_ASL);
   Begin_Fetch_Next_Opcode();
   return;
 }  // 0x1E - ASL  - Arithmetic Shift Left - Absolute , X
@@ -1341,22 +1345,26 @@ uint8_t Calculate_INC(uint8_t local_data) {
 }
 
 void opcode_0xE6() {
-  Double_WriteBack(Calculate_INC(Fetch_ZeroPage()));
+  Fetch_ZeroPage();
+  Double_WriteBack(Calculate_INC);
   Begin_Fetch_Next_Opcode();
   return;
 }  // 0xE6 - INC - ZeroPage
 void opcode_0xF6() {
-  Double_WriteBack(Calculate_INC(Fetch_ZeroPage_X()));
+  Fetch_ZeroPage_X();
+  Double_WriteBack(Calculate_INC);
   Begin_Fetch_Next_Opcode();
   return;
 }  // 0xF6 - INC - ZeroPage , X
 void opcode_0xEE() {
-  Double_WriteBack(Calculate_INC(Fetch_Absolute()));
+  Fetch_Absolute();
+  Double_WriteBack(Calculate_INC);
   Begin_Fetch_Next_Opcode();
   return;
 }  // 0xEE - INC - Absolute
 void opcode_0xFE() {
-  Double_WriteBack(Calculate_INC(Fetch_Absolute_X(0)));
+  Fetch_Absolute_X(0);
+  Double_WriteBack(Calculate_INC);
   Begin_Fetch_Next_Opcode();
   return;
 }  // 0xFE - INC - Absolute , X
@@ -1374,22 +1382,26 @@ uint8_t Calculate_DEC(uint8_t local_data) {
 }
 
 void opcode_0xC6() {
-  Double_WriteBack(Calculate_DEC(Fetch_ZeroPage()));
+  Fetch_ZeroPage();
+  Double_WriteBack(Calculate_DEC);
   Begin_Fetch_Next_Opcode();
   return;
 }  // 0xC6 - DEC - ZeroPage
 void opcode_0xD6() {
-  Double_WriteBack(Calculate_DEC(Fetch_ZeroPage_X()));
+  Fetch_ZeroPage_X();
+  Double_WriteBack(Calculate_DEC);
   Begin_Fetch_Next_Opcode();
   return;
 }  // 0xD6 - DEC - ZeroPage , X
 void opcode_0xCE() {
-  Double_WriteBack(Calculate_DEC(Fetch_Absolute()));
+  Fetch_Absolute();
+  Double_WriteBack(Calculate_DEC);
   Begin_Fetch_Next_Opcode();
   return;
 }  // 0xCE - DEC - Absolute
 void opcode_0xDE() {
-  Double_WriteBack(Calculate_DEC(Fetch_Absolute_X(0)));
+  Fetch_Absolute_X(0);
+  Double_WriteBack(Calculate_DEC);
   Begin_Fetch_Next_Opcode();
   return;
 }  // 0xDE - DEC - Absolute , X
@@ -1410,22 +1422,26 @@ uint8_t Calculate_LSR(uint8_t local_data) {
   return local_data;
 }
 void opcode_0x46() {
-  Double_WriteBack(Calculate_LSR(Fetch_ZeroPage()));
+  Fetch_ZeroPage();
+  Double_WriteBack(Calculate_LSR);
   Begin_Fetch_Next_Opcode();
   return;
 }  // 0x46 - LSR - Logical Shift Right - ZeroPage
 void opcode_0x56() {
-  Double_WriteBack(Calculate_LSR(Fetch_ZeroPage_X()));
+  Fetch_ZeroPage_X();
+  Double_WriteBack(Calculate_LSR);
   Begin_Fetch_Next_Opcode();
   return;
 }  // 0x56 - LSR - Logical Shift Right - ZeroPage , X
 void opcode_0x4E() {
-  Double_WriteBack(Calculate_LSR(Fetch_Absolute()));
+  Fetch_Absolute();
+  Double_WriteBack(Calculate_LSR);
   Begin_Fetch_Next_Opcode();
   return;
 }  // 0x4E - LSR - Logical Shift Right - Absolute
 void opcode_0x5E() {
-  Double_WriteBack(Calculate_LSR(Fetch_Absolute_X(0)));
+  Fetch_Absolute_X(0);
+  Double_WriteBack(Calculate_LSR);
   Begin_Fetch_Next_Opcode();
   return;
 }  // 0x5E - LSR - Logical Shift Right - Absolute , X
@@ -1451,22 +1467,26 @@ uint8_t Calculate_ROR(uint8_t local_data) {
   return local_data;
 }
 void opcode_0x66() {
-  Double_WriteBack(Calculate_ROR(Fetch_ZeroPage()));
+  Fetch_ZeroPage();
+  Double_WriteBack(Calculate_ROR);
   Begin_Fetch_Next_Opcode();
   return;
 }  // 0x66 - ROR - Rotate Right - ZeroPage
 void opcode_0x76() {
-  Double_WriteBack(Calculate_ROR(Fetch_ZeroPage_X()));
+  Fetch_ZeroPage_X();
+  Double_WriteBack(Calculate_ROR);
   Begin_Fetch_Next_Opcode();
   return;
 }  // 0x76 - ROR - Rotate Right - ZeroPage , X
 void opcode_0x6E() {
-  Double_WriteBack(Calculate_ROR(Fetch_Absolute()));
+  Fetch_Absolute();
+  Double_WriteBack(Calculate_ROR);
   Begin_Fetch_Next_Opcode();
   return;
 }  // 0x6E - ROR - Rotate Right - Absolute
 void opcode_0x7E() {
-  Double_WriteBack(Calculate_ROR(Fetch_Absolute_X(0)));
+  Fetch_Absolute_X(0);
+  Double_WriteBack(Calculate_ROR);
   Begin_Fetch_Next_Opcode();
   return;
 }  // 0x7E - ROR - Rotate Right - Absolute , X
@@ -1491,22 +1511,26 @@ uint8_t Calculate_ROL(uint8_t local_data) {
   return local_data;
 }
 void opcode_0x26() {
-  Double_WriteBack(Calculate_ROL(Fetch_ZeroPage()));
+  Fetch_ZeroPage();
+  Double_WriteBack(Calculate_ROL);
   Begin_Fetch_Next_Opcode();
   return;
 }  // 0x26 - ROL - Rotate Left - ZeroPage
 void opcode_0x36() {
-  Double_WriteBack(Calculate_ROL(Fetch_ZeroPage_X()));
+  Fetch_ZeroPage_X();
+  Double_WriteBack(Calculate_ROL);
   Begin_Fetch_Next_Opcode();
   return;
 }  // 0x36 - ROL - Rotate Left - ZeroPage , X
 void opcode_0x2E() {
-  Double_WriteBack(Calculate_ROL(Fetch_Absolute()));
+  Fetch_Absolute();
+  Double_WriteBack(Calculate_ROL);
   Begin_Fetch_Next_Opcode();
   return;
 }  // 0x2E - ROL - Rotate Left - Absolute
 void opcode_0x3E() {
-  Double_WriteBack(Calculate_ROL(Fetch_Absolute_X(0)));
+  Fetch_Absolute_X(0);
+  Double_WriteBack(Calculate_ROL);
   Begin_Fetch_Next_Opcode();
   return;
 }  // 0x3E - ROL - Rotate Left - Absolute , X
@@ -1702,37 +1726,44 @@ uint8_t Calculate_SLO(uint8_t local_data) {
   return local_data;
 }
 void opcode_0x07() {
-  Double_WriteBack(Calculate_SLO(Fetch_ZeroPage()));
+  Fetch_ZeroPage();
+  Double_WriteBack(Calculate_SLO);
   Begin_Fetch_Next_Opcode();
   return;
 }  // 0x07 - SLO - ZeroPage
 void opcode_0x17() {
-  Double_WriteBack(Calculate_SLO(Fetch_ZeroPage_X()));
+  Fetch_ZeroPage_X();
+  Double_WriteBack(Calculate_SLO);
   Begin_Fetch_Next_Opcode();
   return;
 }  // 0x17 - SLO - ZeroPage , X
 void opcode_0x03() {
-  Double_WriteBack(Calculate_SLO(Fetch_Indexed_Indirect_X()));
+  Fetch_Indexed_Indirect_X();
+  Double_WriteBack(Calculate_SLO);
   Begin_Fetch_Next_Opcode();
   return;
 }  // 0x03 - SLO - Indexed Indirect X
 void opcode_0x13() {
-  Double_WriteBack(Calculate_SLO(Fetch_Indexed_Indirect_Y(1)));
+  Fetch_Indexed_Indirect_Y(1);
+  Double_WriteBack(Calculate_SLO);
   Begin_Fetch_Next_Opcode();
   return;
 }  // 0x13 - SLO - Indirect Indexed  Y
 void opcode_0x0F() {
-  Double_WriteBack(Calculate_SLO(Fetch_Absolute()));
+  Fetch_Absolute();
+  Double_WriteBack(Calculate_SLO);
   Begin_Fetch_Next_Opcode();
   return;
 }  // 0x0F - SLO - Absolute
 void opcode_0x1F() {
-  Double_WriteBack(Calculate_SLO(Fetch_Absolute_X(1)));
+  Fetch_Absolute_X(1);
+  Double_WriteBack(Calculate_SLO);
   Begin_Fetch_Next_Opcode();
   return;
 }  // 0x1F - SLO - Absolute , X
 void opcode_0x1B() {
-  Double_WriteBack(Calculate_SLO(Fetch_Absolute_Y(1)));
+  Fetch_Absolute_Y(1);
+  Double_WriteBack(Calculate_SLO);
   Begin_Fetch_Next_Opcode();
   return;
 }  // 0x1B - SLO - Absolute , Y
@@ -1758,37 +1789,44 @@ uint8_t Calculate_RLA(uint8_t local_data) {
   return local_data;
 }
 void opcode_0x27() {
-  Double_WriteBack(Calculate_RLA(Fetch_ZeroPage()));
+  Fetch_ZeroPage();
+  Double_WriteBack(Calculate_RLA);
   Begin_Fetch_Next_Opcode();
   return;
 }  // 0x27 - RLA - ZeroPage
 void opcode_0x37() {
-  Double_WriteBack(Calculate_RLA(Fetch_ZeroPage_X()));
+  Fetch_ZeroPage_X();
+  Double_WriteBack(Calculate_RLA);
   Begin_Fetch_Next_Opcode();
   return;
 }  // 0x37 - RLA - ZeroPage , X
 void opcode_0x23() {
-  Double_WriteBack(Calculate_RLA(Fetch_Indexed_Indirect_X()));
+  Fetch_Indexed_Indirect_X();
+  Double_WriteBack(Calculate_RLA);
   Begin_Fetch_Next_Opcode();
   return;
 }  // 0x23 - RLA - Indexed Indirect X
 void opcode_0x33() {
-  Double_WriteBack(Calculate_RLA(Fetch_Indexed_Indirect_Y(1)));
+  Fetch_Indexed_Indirect_Y(1);
+  Double_WriteBack(Calculate_RLA);
   Begin_Fetch_Next_Opcode();
   return;
 }  // 0x33 - RLA - Indirect Indexed  Y
 void opcode_0x2F() {
-  Double_WriteBack(Calculate_RLA(Fetch_Absolute()));
+  Fetch_Absolute();
+  Double_WriteBack(Calculate_RLA);
   Begin_Fetch_Next_Opcode();
   return;
 }  // 0x2F - RLA - Absolute
 void opcode_0x3F() {
-  Double_WriteBack(Calculate_RLA(Fetch_Absolute_X(1)));
+  Fetch_Absolute_X(1);
+  Double_WriteBack(Calculate_RLA);
   Begin_Fetch_Next_Opcode();
   return;
 }  // 0x3F - RLA - Absolute , X
 void opcode_0x3B() {
-  Double_WriteBack(Calculate_RLA(Fetch_Absolute_Y(1)));
+  Fetch_Absolute_Y(1);
+  Double_WriteBack(Calculate_RLA);
   Begin_Fetch_Next_Opcode();
   return;
 }  // 0x3B - RLA - Absolute , Y
@@ -1810,37 +1848,44 @@ uint8_t Calculate_SRE(uint8_t local_data) {
   return local_data;
 }
 void opcode_0x47() {
-  Double_WriteBack(Calculate_SRE(Fetch_ZeroPage()));
+  Fetch_ZeroPage();
+  Double_WriteBack(Calculate_SRE);
   Begin_Fetch_Next_Opcode();
   return;
 }  // 0x47 - SRE - ZeroPage
 void opcode_0x57() {
-  Double_WriteBack(Calculate_SRE(Fetch_ZeroPage_X()));
+  Fetch_ZeroPage_X();
+  Double_WriteBack(Calculate_SRE);
   Begin_Fetch_Next_Opcode();
   return;
 }  // 0x57 - SRE - ZeroPage , X
 void opcode_0x43() {
-  Double_WriteBack(Calculate_SRE(Fetch_Indexed_Indirect_X()));
+  Fetch_Indexed_Indirect_X();
+  Double_WriteBack(Calculate_SRE);
   Begin_Fetch_Next_Opcode();
   return;
 }  // 0x43 - SRE - Indexed Indirect X
 void opcode_0x53() {
-  Double_WriteBack(Calculate_SRE(Fetch_Indexed_Indirect_Y(1)));
+  Fetch_Indexed_Indirect_Y(1);
+  Double_WriteBack(Calculate_SRE);
   Begin_Fetch_Next_Opcode();
   return;
 }  // 0x53 - SRE - Indirect Indexed  Y
 void opcode_0x4F() {
-  Double_WriteBack(Calculate_SRE(Fetch_Absolute()));
+  Fetch_Absolute();
+  Double_WriteBack(Calculate_SRE);
   Begin_Fetch_Next_Opcode();
   return;
 }  // 0x4F - SRE - Absolute
 void opcode_0x5F() {
-  Double_WriteBack(Calculate_SRE(Fetch_Absolute_X(1)));
+  Fetch_Absolute_X(1);
+  Double_WriteBack(Calculate_SRE);
   Begin_Fetch_Next_Opcode();
   return;
 }  // 0x5F - SRE - Absolute , X
 void opcode_0x5B() {
-  Double_WriteBack(Calculate_SRE(Fetch_Absolute_Y(1)));
+  Fetch_Absolute_Y(1);
+  Double_WriteBack(Calculate_SRE);
   Begin_Fetch_Next_Opcode();
   return;
 }  // 0x5B - SRE - Absolute , Y
@@ -1865,37 +1910,44 @@ uint8_t Calculate_RRA(uint8_t local_data) {
 }
 
 void opcode_0x67() {
-  Double_WriteBack(Calculate_RRA(Fetch_ZeroPage()));
+  Fetch_ZeroPage();
+  Double_WriteBack(Calculate_RRA);
   Calculate_ADC(global_temp);
   return;
 }  // 0x67 - RRA - ZeroPage
 void opcode_0x77() {
-  Double_WriteBack(Calculate_RRA(Fetch_ZeroPage_X()));
+  Fetch_ZeroPage_X();
+  Double_WriteBack(Calculate_RRA);
   Calculate_ADC(global_temp);
   return;
 }  // 0x77 - RRA - ZeroPage , X
 void opcode_0x63() {
-  Double_WriteBack(Calculate_RRA(Fetch_Indexed_Indirect_X()));
+  Fetch_Indexed_Indirect_X();
+  Double_WriteBack(Calculate_RRA);
   Calculate_ADC(global_temp);
   return;
 }  // 0x63 - RRA - Indexed Indirect X
 void opcode_0x73() {
-  Double_WriteBack(Calculate_RRA(Fetch_Indexed_Indirect_Y(1)));
+  Fetch_Indexed_Indirect_Y(1);
+  Double_WriteBack(Calculate_RRA);
   Calculate_ADC(global_temp);
   return;
 }  // 0x73 - RRA - Indirect Indexed  Y
 void opcode_0x6F() {
-  Double_WriteBack(Calculate_RRA(Fetch_Absolute()));
+  Fetch_Absolute();
+  Double_WriteBack(Calculate_RRA);
   Calculate_ADC(global_temp);
   return;
 }  // 0x6F - RRA - Absolute
 void opcode_0x7F() {
-  Double_WriteBack(Calculate_RRA(Fetch_Absolute_X(1)));
+  Fetch_Absolute_X(1);
+  Double_WriteBack(Calculate_RRA);
   Calculate_ADC(global_temp);
   return;
 }  // 0x7F - RRA - Absolute , X
 void opcode_0x7B() {
-  Double_WriteBack(Calculate_RRA(Fetch_Absolute_Y(1)));
+  Fetch_Absolute_Y(1);
+  Double_WriteBack(Calculate_RRA);
   Calculate_ADC(global_temp);
   return;
 }  // 0x7B - RRA - Absolute , Y
@@ -1978,37 +2030,44 @@ void opcode_0xBF() {
 // Decrement the contents of a memory location and then compare the result with the A register.
 // --------------------------------------------------------------------------------------------------
 void opcode_0xC7() {
-  Double_WriteBack(Calculate_DEC(Fetch_ZeroPage()));
+  Fetch_ZeroPage();
+  Double_WriteBack(Calculate_DEC);
   Calculate_CMP(global_temp);
   return;
 }  // 0xC7 - DCP - ZeroPage
 void opcode_0xD7() {
-  Double_WriteBack(Calculate_DEC(Fetch_ZeroPage_X()));
+  Fetch_ZeroPage_X();
+  Double_WriteBack(Calculate_DEC);
   Calculate_CMP(global_temp);
   return;
 }  // 0xD7 - DCP - ZeroPage , X
 void opcode_0xC3() {
-  Double_WriteBack(Calculate_DEC(Fetch_Indexed_Indirect_X()));
+  Fetch_Indexed_Indirect_X();
+  Double_WriteBack(Calculate_DEC);
   Calculate_CMP(global_temp);
   return;
 }  // 0xC3 - DCP - Indexed Indirect X
 void opcode_0xD3() {
-  Double_WriteBack(Calculate_DEC(Fetch_Indexed_Indirect_Y(0)));
+  Fetch_Indexed_Indirect_Y(0);
+  Double_WriteBack(Calculate_DEC);
   Calculate_CMP(global_temp);
   return;
 }  // 0xD3 - DCP - Indirect Indexed  Y
 void opcode_0xCF() {
-  Double_WriteBack(Calculate_DEC(Fetch_Absolute()));
+  Fetch_Absolute();
+  Double_WriteBack(Calculate_DEC);
   Calculate_CMP(global_temp);
   return;
 }  // 0xCF - DCP - Absolute
 void opcode_0xDF() {
-  Double_WriteBack(Calculate_DEC(Fetch_Absolute_X(0)));
+  Fetch_Absolute_X(0);
+  Double_WriteBack(Calculate_DEC);
   Calculate_CMP(global_temp);
   return;
 }  // 0xDF - DCP - Absolute , X
 void opcode_0xDB() {
-  Double_WriteBack(Calculate_DEC(Fetch_Absolute_Y(0)));
+  Fetch_Absolute_Y(0);
+  Double_WriteBack(Calculate_DEC);
   Calculate_CMP(global_temp);
   return;
 }  // 0xDB - DCP - Absolute , Y
@@ -2019,37 +2078,44 @@ void opcode_0xDB() {
 // ISC - Increase memory by one, then subtract memory from accumulator (with borrow).
 // --------------------------------------------------------------------------------------------------
 void opcode_0xE7() {
-  Double_WriteBack(Calculate_INC(Fetch_ZeroPage()));
+  Fetch_ZeroPage();
+  Double_WriteBack(Calculate_INC);
   Calculate_SBC(global_temp);
   return;
 }  // 0xE7 - ISC - ZeroPage
 void opcode_0xF7() {
-  Double_WriteBack(Calculate_INC(Fetch_ZeroPage_X()));
+  Fetch_ZeroPage_X();
+  Double_WriteBack(Calculate_INC);
   Calculate_SBC(global_temp);
   return;
 }  // 0xF7 - ISC - ZeroPage , X
 void opcode_0xE3() {
-  Double_WriteBack(Calculate_INC(Fetch_Indexed_Indirect_X()));
+  Fetch_Indexed_Indirect_X();
+  Double_WriteBack(Calculate_INC);
   Calculate_SBC(global_temp);
   return;
 }  // 0xE3 - ISC - Indexed Indirect X
 void opcode_0xF3() {
-  Double_WriteBack(Calculate_INC(Fetch_Indexed_Indirect_Y(0)));
+  Fetch_Indexed_Indirect_Y(0);
+  Double_WriteBack(Calculate_INC);
   Calculate_SBC(global_temp);
   return;
 }  // 0xF3 - ISC - Indirect Indexed  Y
 void opcode_0xEF() {
-  Double_WriteBack(Calculate_INC(Fetch_Absolute()));
+  Fetch_Absolute();
+  Double_WriteBack(Calculate_INC);
   Calculate_SBC(global_temp);
   return;
 }  // 0xEF - ISC - Absolute
 void opcode_0xFF() {
-  Double_WriteBack(Calculate_INC(Fetch_Absolute_X(0)));
+  Fetch_Absolute_X(0);
+  Double_WriteBack(Calculate_INC);
   Calculate_SBC(global_temp);
   return;
 }  // 0xFF - ISC - Absolute , X
 void opcode_0xFB() {
-  Double_WriteBack(Calculate_INC(Fetch_Absolute_Y(0)));
+  Fetch_Absolute_Y(0);
+  Double_WriteBack(Calculate_INC);
   Calculate_SBC(global_temp);
   return;
 }  // 0xFB - ISC - Absolute , Y
@@ -0,0 +1,237 @@
+// ============================================================================
+// MCL64 - Per-Program Acceleration Profiles
+// ----------------------------------------------------------------------------
+// When a program is started with SYS or RUN the code it starts is hashed
+// into a 32-bit signature.  A table of profiles kept in the Teensy EEPROM
+// maps signatures to an acceleration mode, a throttle and per-page caps
+// so each title in a library runs with its own settings.
+//
+// SYS  - 256 bytes at the SYS target in RAM below BASIC or at $C000-$CFFF,
+//        hashed at the JMP ($0014) at $E144
+// RUN  - the program from TXTTAB to VARTAB, hashed on entry to RUN at $A871
+//
+// The F command over the UART reports the signature of the last program
+// started so a profile can be written for it.  A profile is applied before
+// the opcode at $E144 or $A871 is fetched again, so it takes effect from
+// that instruction on.
+// ============================================================================
+
+#ifndef PROGRAM_PROFILES_H
+#define PROGRAM_PROFILES_H
+
+#if ENABLE_ACCELERATION
+
+#include <EEPROM.h>
+
+#define PROGRAM_PROFILES        16
+#define PROGRAM_PROFILE_MAGIC   0x50434C4D      // "MCLP"
+#define PROGRAM_SYS_HASH_BYTES  256
+#define PROGRAM_PROFILE_MODE_MAX 4       // Modes 0-4, 4 = adaptive
+
+extern uint8_t   page_cap[256];
+extern uint8_t   throttle;
+extern uint8_t   current_p;
+extern void      rebuild_page_access_map();
+extern void      set_throttle(uint8_t multiplier);
+extern void      flush_posted_writes();
+extern void      select_mode(uint8_t new_mode);
+extern uint32_t  parse_serial_number(char **text, uint8_t base);
+
+struct program_profile {
+  uint32_t  signature;                // 0 = unused slot
+  uint8_t   mode;
+  uint8_t   throttle;
+  uint8_t   page_caps[64];            // 2 bits per page, 3 = no cap
+};
+
+program_profile program_profiles[PROGRAM_PROFILES];
+uint32_t  program_signature=0;
+uint8_t   program_profile_active=0;
+uint8_t   profile_baseline_mode=0;
+uint8_t   profile_baseline_throttle=0;
+
+
+// -------------------------------------------------
+// EEPROM storage - a magic word followed by the profile slots
+// -------------------------------------------------
+void load_program_profiles() {
+  uint32_t magic;
+  uint8_t  slot;
+
+    EEPROM.get(0, magic);
+    for (slot=0; slot<PROGRAM_PROFILES; slot++) {
+      if (magic==PROGRAM_PROFILE_MAGIC) EEPROM.get(4 + slot*sizeof(program_profile), program_profiles[slot]);
+      else {
+        program_profiles[slot].signature = 0;
+        memset(program_profiles[slot].page_caps, 0xFF, sizeof(program_profiles[slot].page_caps));
+      }
+    }
+    return;
+}
+
+void save_program_profile(uint8_t slot) {
+  uint32_t magic;
+  uint8_t  other;
+
+    EEPROM.get(0, magic);
+    if (magic!=PROGRAM_PROFILE_MAGIC) {                                  // First save, the other slots are still erased
+      for (other=0; other<PROGRAM_PROFILES; other++) EEPROM.put(4 + other*sizeof(program_profile), program_profiles[other]);
+      magic = PROGRAM_PROFILE_MAGIC;
+      EEPROM.put(0, magic);
+      return;
+    }
+    EEPROM.put(4 + slot*sizeof(program_profile), program_profiles[slot]);
+    return;
+}
+
+
+// -------------------------------------------------
+// FNV-1a hash of internal_RAM
+// -------------------------------------------------
+uint32_t hash_program(uint16_t local_address, uint16_t length) {
+  uint32_t hash=0x811C9DC5;
+
+    while (length--) {
+      hash = (hash ^ internal_RAM[local_address++]) * 0x01000193;
+    }
+    return hash;
+}
+
+
+// -------------------------------------------------
+// Apply the profile matching the signature, or return to the settings
+// in use before the last profile when there is none
+//  Return: 1 when the settings changed
+// -------------------------------------------------
+uint8_t apply_program_profile(uint32_t signature) {
+  uint8_t  slot;
+  uint16_t page;
+
+    for (slot=0; slot<PROGRAM_PROFILES; slot++) {
+      if (program_profiles[slot].signature==signature) break;
+    }
+    if (slot==PROGRAM_PROFILES && program_profile_active==0) return 0;
+
+    flush_posted_writes();
+    if (program_profile_active==0) {
+      profile_baseline_mode     = mode;
+      profile_baseline_throttle = throttle;
+    }
+
+    if (slot<PROGRAM_PROFILES) {
+      program_profile_active = 1;
+      select_mode(program_profiles[slot].mode);
+      set_throttle(program_profiles[slot].throttle);
+      for (page=0; page<256; page++) page_cap[page] = (program_profiles[slot].page_caps[page>>2] >> ((page&0x3)<<1)) & 0x3;
+    }
+    else {
+      program_profile_active = 0;
+      select_mode(profile_baseline_mode);
+      set_throttle(profile_baseline_throttle);
+      memset(page_cap, 0x3, sizeof(page_cap));
+    }
+    rebuild_page_access_map();
+    return 1;
+}
+
+
+// -------------------------------------------------
+// Called between instructions for the SYS jump and the start of RUN
+//  Return: 1 when a profile changed the settings and the opcode fetch
+//          in flight must be reissued
+// -------------------------------------------------
+uint8_t profile_program_entry(uint16_t local_pc) {
+  uint16_t start, end;
+
+    if (local_pc==0xE144 && (current_p&0x2)==0x2) {                      // SYS - JMP ($0014) with the KERNAL mapped in
+      start = internal_RAM[0x14] | (internal_RAM[0x15]<<8);
+      if (start >= 0xA000-PROGRAM_SYS_HASH_BYTES &&                      // Only programs in RAM below BASIC or at $C000
+          (start < 0xC000 || start > 0xD000-PROGRAM_SYS_HASH_BYTES)) return 0;
+      program_signature = hash_program(start, PROGRAM_SYS_HASH_BYTES);
+    }
+    else if (local_pc==0xA871 && (current_p&0x3)==0x3) {                 // RUN with BASIC mapped in
+      start = internal_RAM[0x2B] | (internal_RAM[0x2C]<<8);               // TXTTAB
+      end   = internal_RAM[0x2D] | (internal_RAM[0x2E]<<8);               // VARTAB
+      if (end <= start || end > 0xA000) return 0;
+      program_signature = hash_program(start, end-start);
+    }
+    else return 0;
+
+    return apply_program_profile(program_signature);
+}
+
+
+// -------------------------------------------------
+// UART commands
+//  F                                    - List the profiles, the last signature and the mode of an active profile
+//  F<slot>,<signature>,<mode>,<mhz>     - Write a profile, all pages uncapped
+//  FP<slot>,<first page>,<last page>,<cap> - Cap a range of pages at an access level 0-3
+//  FX<slot>                             - Erase a profile
+// Signatures and pages are hex.
+// -------------------------------------------------
+void report_program_profiles() {
+  uint8_t slot;
+
+    Serial.print("F");  Serial.println(program_signature, HEX);
+    if (program_profile_active) {  Serial.print("M");  Serial.println(mode);  }   // Mode the profile selected
+    for (slot=0; slot<PROGRAM_PROFILES; slot++) {
+      if (program_profiles[slot].signature==0) continue;
+      Serial.print("F");  Serial.print(slot);
+      Serial.print(",");  Serial.print(program_profiles[slot].signature, HEX);
+      Serial.print(",");  Serial.print(program_profiles[slot].mode);
+      Serial.print(",");  Serial.println(program_profiles[slot].throttle);
+    }
+    return;
+}
+
+void process_profile_command(char *text) {
+  uint8_t  slot;
+  uint8_t  command=0;
+  uint16_t page, last_page;
+  uint8_t  cap;
+  uint32_t value;
+
+    if (*text==0) {
+      report_program_profiles();
+      return;
+    }
+    if (*text=='P' || *text=='p' || *text=='X' || *text=='x') command = *text++ & 0xDF;
+
+    slot = parse_serial_number(&text, 10);
+    if (slot>=PROGRAM_PROFILES) {
+      Serial.println("?");
+      return;
+    }
+
+    switch (command) {
+      case 'P':
+        page      = parse_serial_number(&text, 16) & 0xFF;
+        last_page = parse_serial_number(&text, 16) & 0xFF;
+        cap       = parse_serial_number(&text, 10) & 0x3;
+        for (; page<=last_page; page++) {
+          program_profiles[slot].page_caps[page>>2] &= ~(0x3 << ((page&0x3)<<1));
+          program_profiles[slot].page_caps[page>>2] |=  (cap << ((page&0x3)<<1));
+        }
+        break;
+
+      case 'X':
+        program_profiles[slot].signature = 0;
+        break;
+
+      default:
+        program_profiles[slot].signature = parse_serial_number(&text, 16);
+        value = parse_serial_number(&text, 10);
+        program_profiles[slot].mode      = (value>PROGRAM_PROFILE_MODE_MAX) ? PROGRAM_PROFILE_MODE_MAX : value;
+        value = parse_serial_number(&text, 10);
+        program_profiles[slot].throttle  = (value>THROTTLE_MAX) ? THROTTLE_MAX : value;
+        memset(program_profiles[slot].page_caps, 0xFF, sizeof(program_profiles[slot].page_caps));
+        break;
+    }
+    save_program_profile(slot);
+    report_program_profiles();
+    return;
+}
+
+#endif // ENABLE_ACCELERATION
+
+#endif // PROGRAM_PROFILES_H
@@ -0,0 +1,147 @@
+// ============================================================================
+// MCL64 - VIC Raster Estimator
+// ----------------------------------------------------------------------------
+// Keeps an estimate of the VIC raster line and cycle so the bus interface
+// can tell when the VIC is about to pull READY for a badline or for sprite
+// DMA.  Queued write-through writes are held while a stall is predicted
+// and the CPU keeps running from internal memory; they drain once the VIC
+// has released the bus.
+//
+// The 6510 sees no CLK edges while it runs internally, so time is kept on
+// the DWT cycle counter at the phi2 rate.  Each bus read of $D012 (and of
+// $D011 for raster bit 8) resynchronizes the estimate.  The badline and
+// sprite DMA conditions use the $D011, $D015, $D017 and sprite Y values
+// held in the VIC shadow registers.
+//
+// RASTER_NTSC in MCL64.ino selects the 6567 NTSC timing instead of PAL.
+// ============================================================================
+
+#ifndef RASTER_ESTIMATOR_H
+#define RASTER_ESTIMATOR_H
+
+#if ENABLE_ACCELERATION
+
+#if RASTER_NTSC
+#define RASTER_CYCLES_PER_LINE  65
+#define RASTER_LINES            263
+#define RASTER_PHI2_HZ          1022727
+#else
+#define RASTER_CYCLES_PER_LINE  63
+#define RASTER_LINES            312
+#define RASTER_PHI2_HZ          985248
+#endif
+
+#define RASTER_BADLINE_BA       12      // BA drops 3 cycles before the first c-access at cycle 15
+#define RASTER_BADLINE_END      54
+#define RASTER_SPRITE_BA        55      // BA drops for sprite 0 three cycles before its p-access at cycle 58
+#define RASTER_SPRITE_END       10      // Sprite 7 s-accesses end at cycle 10 of the next line
+
+uint32_t  raster_ticks_per_line=0;
+uint32_t  raster_anchor_ticks=0;        // DWT count at the start of raster_anchor_line
+uint16_t  raster_anchor_line=0;
+uint8_t   raster_synced=0;
+uint16_t  raster_line=0;
+uint8_t   raster_cycle=0;
+
+
+// -------------------------------------------------
+// Advance the estimate to the current DWT count
+// -------------------------------------------------
+inline void update_raster_position() {
+  uint32_t elapsed;
+  uint32_t lines;
+
+    elapsed = ARM_DWT_CYCCNT - raster_anchor_ticks;
+    lines   = elapsed / raster_ticks_per_line;
+    elapsed = elapsed - lines*raster_ticks_per_line;
+
+    raster_anchor_ticks += lines*raster_ticks_per_line;             // Keep the anchor close so the DWT count cannot wrap past it
+    raster_anchor_line   = (raster_anchor_line + lines) % RASTER_LINES;
+
+    raster_line  = raster_anchor_line;
+    raster_cycle = (elapsed * RASTER_CYCLES_PER_LINE) / raster_ticks_per_line;
+    return;
+}
+
+
+// -------------------------------------------------
+// Resynchronize from a bus read of $D011 or $D012
+// -------------------------------------------------
+inline void raster_observe_read(uint16_t local_address , uint8_t local_data) {
+  uint8_t  reg;
+  uint16_t line;
+
+    if ((local_address&0xFC00)!=0xD000 || !IO_MAPPED_IN) return;
+    reg = local_address & 0x3F;
+    if (reg!=0x11 && reg!=0x12) return;
+
+    update_raster_position();
+
+    if (reg==0x12) {
+      if (raster_synced && (raster_line&0xFF)==local_data) return;   // Estimate agrees
+      line = (raster_line&0x100) | local_data;
+      if (line>=RASTER_LINES) line = local_data;
+      raster_anchor_ticks = ARM_DWT_CYCCNT;                           // The line changed since the last read, so it has just started
+      raster_anchor_line  = line;
+      raster_synced = 1;
+    }
+    else if ( ((raster_line>>1)&0x80) != (local_data&0x80) ) {      // Raster bit 8 disagrees
+      raster_anchor_line = (raster_anchor_line ^ 0x100);
+      if (raster_anchor_line>=RASTER_LINES) raster_anchor_line = RASTER_LINES-1;
+    }
+    return;
+}
+
+
+// -------------------------------------------------
+// Sprites fetched at the end of the given line
+// -------------------------------------------------
+inline uint8_t raster_sprite_dma(uint16_t line) {
+  uint8_t  sprite;
+  uint8_t  height;
+  uint8_t  sprite_line;
+
+    if (vic_shadow_valid[0x15]==0 || vic_shadow[0x15]==0) return 0;
+
+    for (sprite=0; sprite<8; sprite++) {
+      if ((vic_shadow[0x15] & (1<<sprite))==0 || vic_shadow_valid[1+(sprite<<1)]==0) continue;
+      height = (vic_shadow_valid[0x17] && (vic_shadow[0x17] & (1<<sprite))) ? 42 : 21;
+      sprite_line = (line + 1 - vic_shadow[1+(sprite<<1)]) & 0xFF;   // DMA starts the line before the sprite's first line
+      if (sprite_line < height) return 1;
+    }
+    return 0;
+}
+
+
+// -------------------------------------------------
+// Is the VIC holding (or about to hold) READY now?
+// -------------------------------------------------
+inline uint8_t raster_stall_predicted() {
+  uint8_t  d011;
+
+    if (raster_synced==0) return 0;
+    update_raster_position();
+
+    if (vic_shadow_valid[0x11]) {
+      d011 = vic_shadow[0x11];
+      if ( (d011&0x10) && raster_line>=0x30 && raster_line<=0xF7 && (raster_line&0x7)==(d011&0x7) &&
+           raster_cycle>=RASTER_BADLINE_BA && raster_cycle<=RASTER_BADLINE_END ) return 1;
+    }
+
+    if (raster_cycle>=RASTER_SPRITE_BA) return raster_sprite_dma(raster_line);
+    if (raster_cycle<=RASTER_SPRITE_END) return raster_sprite_dma(raster_line==0 ? RASTER_LINES-1 : raster_line-1);
+    return 0;
+}
+
+
+void raster_estimator_reset() {
+    raster_ticks_per_line = (uint32_t)(((uint64_t)F_CPU_ACTUAL * RASTER_CYCLES_PER_LINE) / RASTER_PHI2_HZ);
+    raster_anchor_ticks   = ARM_DWT_CYCCNT;
+    raster_anchor_line    = 0;
+    raster_synced = 0;
+    return;
+}
+
+#endif // ENABLE_ACCELERATION
+
+#endif // RASTER_ESTIMATOR_H
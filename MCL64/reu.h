@@ -0,0 +1,201 @@
+// ============================================================================
+// MCL64 - 17xx RAM Expansion Unit
+// ----------------------------------------------------------------------------
+// REU registers at $DF00-$DF0A (mirrored every 32 bytes up to $DFFF) with
+// the expansion memory held in Teensy PSRAM.  A transfer runs when the
+// command register is written with bit 7 set, or on the next write to
+// $FF00 when bit 4 is clear, and completes before the next instruction.
+//
+// The C64 side of a transfer goes through read_byte()/write_byte(), so
+// memory that is internal in the current mode costs no bus cycles while
+// write-through and I/O pages still reach the motherboard.
+//
+// The registers are not decoded while an EasyFlash image is selected with
+// 'C<n>', as its RAM occupies $DF00-$DFFF.
+//
+//  $DF00  Status         7 IRQ, 6 end of block, 5 verify error, 4 size
+//  $DF01  Command        7 execute, 5 autoload, 4 no $FF00 trigger, 1-0 type
+//  $DF02  C64 address    low, high
+//  $DF04  REU address    low, high, bank
+//  $DF07  Length         low, high (0 = 64KB)
+//  $DF09  IRQ mask       7 enable, 6 end of block, 5 verify error
+//  $DF0A  Address control 7 fix C64 address, 6 fix REU address
+// ============================================================================
+
+#ifndef REU_H
+#define REU_H
+
+#if ENABLE_ACCELERATION && ENABLE_REU
+
+#define REU_SIZE        ((uint32_t)REU_SIZE_KB * 1024)
+#define REU_BANK_MASK   ((REU_SIZE_KB/64) - 1)
+
+#define REU_STASH       0x0
+#define REU_FETCH       0x1
+#define REU_SWAP        0x2
+#define REU_VERIFY      0x3
+
+extern uint8_t   current_p;
+extern uint8_t   read_byte(uint16_t local_address);
+extern void      write_byte(uint16_t local_address , uint8_t local_write_data);
+
+EXTMEM uint8_t reu_memory[REU_SIZE];
+
+uint8_t   reu_status=0;
+uint8_t   reu_command=0x10;
+uint16_t  reu_c64_address=0;
+uint32_t  reu_address=0;
+uint16_t  reu_length=0xFFFF;
+uint8_t   reu_irq_mask=0x1F;
+uint8_t   reu_address_control=0x3F;
+
+uint16_t  reu_c64_address_reload=0;   // Values written by the CPU, restored by autoload
+uint32_t  reu_address_reload=0;
+uint16_t  reu_length_reload=0xFFFF;
+
+uint8_t   reu_armed=0;                // Command with the execute bit is waiting for its trigger
+
+
+// -------------------------------------------------
+// Run the programmed transfer
+// -------------------------------------------------
+void reu_execute() {
+  uint32_t count;
+  uint8_t  c64_data=0;
+  uint8_t  reu_data=0;
+  uint8_t  type = reu_command & 0x3;
+
+    reu_armed = 0;
+    count = (reu_length==0) ? 0x10000 : reu_length;
+
+    while (count!=0) {
+      switch (type) {
+        case REU_STASH:
+          reu_memory[reu_address] = read_byte(reu_c64_address);
+          break;
+
+        case REU_FETCH:
+          write_byte(reu_c64_address, reu_memory[reu_address]);
+          break;
+
+        case REU_SWAP:
+          c64_data = read_byte(reu_c64_address);
+          write_byte(reu_c64_address, reu_memory[reu_address]);
+          reu_memory[reu_address] = c64_data;
+          break;
+
+        case REU_VERIFY:
+          c64_data = read_byte(reu_c64_address);
+          reu_data = reu_memory[reu_address];
+          break;
+      }
+
+      if ((reu_address_control&0x80)==0) reu_c64_address++;
+      if ((reu_address_control&0x40)==0) reu_address = (reu_address+1) & (REU_SIZE-1);
+      count--;
+
+      if (type==REU_VERIFY && c64_data!=reu_data) {
+        reu_status |= 0x20;
+        break;
+      }
+    }
+
+    if (count==0) reu_status |= 0x40;
+    reu_length = (count==0) ? 1 : count;
+
+    if (reu_command&0x20) {                                            // Autoload
+      reu_c64_address = reu_c64_address_reload;
+      reu_address     = reu_address_reload;
+      reu_length      = reu_length_reload;
+    }
+    reu_command = (reu_command & 0x7F) | 0x10;
+
+    if ((reu_irq_mask&0x80) && (reu_status & reu_irq_mask & 0x60)) reu_status |= 0x80;
+    return;
+}
+
+
+// -------------------------------------------------
+// Called after every write_byte() while a command is armed
+// -------------------------------------------------
+inline void reu_check_trigger(uint16_t local_address) {
+    if ((reu_command&0x10) || local_address==0xFF00) reu_execute();
+    return;
+}
+
+
+// -------------------------------------------------
+// Register writes
+// -------------------------------------------------
+inline void reu_io_write(uint16_t local_address , uint8_t local_write_data) {
+
+    if ((current_p&0x4)==0 || (current_p&0x3)==0) return;              // I/O not mapped in
+    if (cart_io2_claimed()) return;                                    // EasyFlash RAM at $DF00
+
+    switch (local_address & 0x1F) {
+      case 0x01:
+        reu_command = local_write_data;
+        reu_armed   = (local_write_data&0x80)!=0;
+        break;
+      case 0x02: reu_c64_address = (reu_c64_address & 0xFF00) | local_write_data;              reu_c64_address_reload = reu_c64_address;  break;
+      case 0x03: reu_c64_address = (reu_c64_address & 0x00FF) | (local_write_data<<8);         reu_c64_address_reload = reu_c64_address;  break;
+      case 0x04: reu_address = (reu_address & 0xFFFF00) | local_write_data;                    reu_address_reload = reu_address;          break;
+      case 0x05: reu_address = (reu_address & 0xFF00FF) | (local_write_data<<8);               reu_address_reload = reu_address;          break;
+      case 0x06: reu_address = (reu_address & 0x00FFFF) | ((uint32_t)(local_write_data&REU_BANK_MASK)<<16);  reu_address_reload = reu_address;  break;
+      case 0x07: reu_length = (reu_length & 0xFF00) | local_write_data;                        reu_length_reload = reu_length;            break;
+      case 0x08: reu_length = (reu_length & 0x00FF) | (local_write_data<<8);                   reu_length_reload = reu_length;            break;
+      case 0x09: reu_irq_mask = local_write_data | 0x1F;                                                                                  break;
+      case 0x0A: reu_address_control = local_write_data | 0x3F;                                                                           break;
+    }
+    return;
+}
+
+
+// -------------------------------------------------
+// Register reads
+//  Return: 1 with the data in *local_data
+// -------------------------------------------------
+inline uint8_t reu_io_read(uint16_t local_address , uint8_t *local_data) {
+
+    if ((local_address&0xFF00)!=0xDF00 || (current_p&0x4)==0 || (current_p&0x3)==0) return 0;
+    if (cart_io2_claimed()) return 0;                                  // EasyFlash RAM at $DF00
+
+    switch (local_address & 0x1F) {
+      case 0x00:
+        *local_data = reu_status | ((REU_SIZE_KB>128) ? 0x10 : 0x00);
+        reu_status  = 0;                                                 // Reading the status clears the interrupt and flags
+        break;
+      case 0x01: *local_data = reu_command;                                  break;
+      case 0x02: *local_data = reu_c64_address;                              break;
+      case 0x03: *local_data = reu_c64_address >> 8;                         break;
+      case 0x04: *local_data = reu_address;                                  break;
+      case 0x05: *local_data = reu_address >> 8;                             break;
+      case 0x06: *local_data = (reu_address >> 16) | ~REU_BANK_MASK;         break;
+      case 0x07: *local_data = reu_length;                                   break;
+      case 0x08: *local_data = reu_length >> 8;                              break;
+      case 0x09: *local_data = reu_irq_mask;                                 break;
+      case 0x0A: *local_data = reu_address_control;                          break;
+      default:   *local_data = 0xFF;                                         break;
+    }
+    return 1;
+}
+
+
+// -------------------------------------------------
+// The REU is reset with the CPU
+// -------------------------------------------------
+void reu_reset() {
+    reu_status  = 0;
+    reu_command = 0x10;
+    reu_c64_address = reu_c64_address_reload = 0;
+    reu_address     = reu_address_reload     = 0;
+    reu_length      = reu_length_reload      = 0xFFFF;
+    reu_irq_mask        = 0x1F;
+    reu_address_control = 0x3F;
+    reu_armed = 0;
+    return;
+}
+
+#endif // ENABLE_ACCELERATION && ENABLE_REU
+
+#endif // REU_H
@@ -0,0 +1,192 @@
+// ============================================================================
+// MCL64 - Virtual CIA Timers
+// ----------------------------------------------------------------------------
+// The CIA timers count real 1 MHz cycles, so a delay loop that polls them
+// gains nothing from acceleration.  With 'V1' over the UART, the timers
+// of a CIA with no interrupts enabled are counted in the core's own cycle
+// domain (bus cycles plus cycles run from internal memory) and reads of
+// $DC04-$DC07/$DD04-$DD07, the ICR and CRA/CRB are answered from here.
+//
+// Every write still reaches the real chip.  As soon as a CIA enables an
+// interrupt in its ICR the real chip is read again, since the IRQ or NMI
+// line is driven by its timers.  Timers counting CNT pulses and TOD stay
+// on the real chip.
+// ============================================================================
+
+#ifndef VIRTUAL_CIA_H
+#define VIRTUAL_CIA_H
+
+#if ENABLE_ACCELERATION
+
+extern uint32_t  phi2_cycles;
+extern uint32_t  internal_cycles;
+extern uint8_t   read_byte(uint16_t local_address);
+
+struct virtual_timer {
+  uint16_t  latch;
+  uint16_t  counter;
+  uint8_t   control;
+};
+
+struct virtual_cia_state {
+  virtual_timer  timer_a;
+  virtual_timer  timer_b;
+  uint8_t   icr_mask;
+  uint8_t   icr_flags;
+  uint32_t  last_cycle;
+};
+
+virtual_cia_state virtual_cias[2];
+uint8_t   virtual_cia=0;              // Set with 'V1' over the UART
+
+
+// -------------------------------------------------
+// Count a timer down by a number of ticks
+//  Return: underflows during the ticks
+// -------------------------------------------------
+uint32_t advance_virtual_timer(virtual_timer *timer, uint32_t ticks) {
+  uint32_t underflows;
+  uint32_t period;
+
+    if ((timer->control&0x01)==0 || ticks==0) return 0;
+    if (ticks <= timer->counter) {
+      timer->counter -= ticks;
+      return 0;
+    }
+
+    ticks -= timer->counter + 1;                                        // First underflow reloads the latch
+    timer->counter = timer->latch;
+    if ((timer->control&0x08)!=0) {                                     // One-shot stops after it
+      timer->control &= 0xFE;
+      return 1;
+    }
+    period = timer->latch + 1;
+    underflows = 1 + ticks / period;
+    timer->counter = timer->latch - (ticks % period);
+    return underflows;
+}
+
+
+// -------------------------------------------------
+// Bring a CIA up to the current core cycle
+// -------------------------------------------------
+void update_virtual_cia(virtual_cia_state *cia) {
+  uint32_t now = phi2_cycles + internal_cycles;
+  uint32_t elapsed = now - cia->last_cycle;
+  uint32_t underflows_a, underflows_b;
+
+    cia->last_cycle = now;
+
+    underflows_a = advance_virtual_timer(&cia->timer_a, elapsed);
+    if (underflows_a!=0) cia->icr_flags |= 0x01;
+
+    if ((cia->timer_b.control&0x60)==0x40) underflows_b = advance_virtual_timer(&cia->timer_b, underflows_a);
+    else                                   underflows_b = advance_virtual_timer(&cia->timer_b, elapsed);
+    if (underflows_b!=0) cia->icr_flags |= 0x02;
+    return;
+}
+
+
+// -------------------------------------------------
+// The timers of a CIA are virtual while it has no interrupts enabled and
+// both run from phi2 (or timer B from timer A underflows)
+// -------------------------------------------------
+inline uint8_t virtual_cia_active(virtual_cia_state *cia) {
+    if (virtual_cia==0 || cia->icr_mask!=0) return 0;
+    if ((cia->timer_a.control&0x20)!=0) return 0;
+    if ((cia->timer_b.control&0x60)==0x20 || (cia->timer_b.control&0x60)==0x60) return 0;
+    return 1;
+}
+
+
+// -------------------------------------------------
+// Record a CPU write to a CIA register
+// -------------------------------------------------
+void virtual_cia_write(uint16_t local_address , uint8_t local_write_data) {
+  virtual_cia_state *cia = &virtual_cias[(local_address>>8)&0x1];
+  virtual_timer     *timer;
+  uint8_t reg = local_address & 0x0F;
+
+    update_virtual_cia(cia);
+
+    switch (reg) {
+      case 0x4: case 0x6:
+        timer = (reg==0x4) ? &cia->timer_a : &cia->timer_b;
+        timer->latch = (timer->latch & 0xFF00) | local_write_data;
+        break;
+
+      case 0x5: case 0x7:
+        timer = (reg==0x5) ? &cia->timer_a : &cia->timer_b;
+        timer->latch = (timer->latch & 0x00FF) | (local_write_data<<8);
+        if ((timer->control&0x01)==0) timer->counter = timer->latch;    // A stopped timer loads on the high byte write
+        break;
+
+      case 0xD:
+        if ((local_write_data&0x80)!=0) {
+          if (virtual_cia_active(cia) && (local_write_data&0x1F)!=0) {
+            read_byte(local_address);                                   // Discard flags the real chip raised while it was not being read
+          }
+          cia->icr_mask |= (local_write_data & 0x1F);
+        }
+        else cia->icr_mask &= ~local_write_data;
+        break;
+
+      case 0xE: case 0xF:
+        timer = (reg==0xE) ? &cia->timer_a : &cia->timer_b;
+        if ((local_write_data&0x10)!=0) timer->counter = timer->latch;  // Force load strobe
+        timer->control = local_write_data & 0xEF;
+        break;
+    }
+    return;
+}
+
+
+// -------------------------------------------------
+// Serve a CIA read from the virtual timers
+//  Return: 1 with the data in *local_data, 0 when the bus must be read
+// -------------------------------------------------
+uint8_t virtual_cia_read(uint16_t local_address , uint8_t *local_data) {
+  virtual_cia_state *cia = &virtual_cias[(local_address>>8)&0x1];
+  uint8_t reg = local_address & 0x0F;
+
+    if (reg<0x4 || (reg>=0x8 && reg<=0xC)) return 0;                    // Ports, TOD and serial register stay real
+    if (!virtual_cia_active(cia)) return 0;
+
+    update_virtual_cia(cia);
+
+    switch (reg) {
+      case 0x4: *local_data = cia->timer_a.counter;       break;
+      case 0x5: *local_data = cia->timer_a.counter >> 8;  break;
+      case 0x6: *local_data = cia->timer_b.counter;       break;
+      case 0x7: *local_data = cia->timer_b.counter >> 8;  break;
+      case 0xD:
+        *local_data = cia->icr_flags;
+        cia->icr_flags = 0;
+        break;
+      case 0xE: *local_data = cia->timer_a.control;       break;
+      case 0xF: *local_data = cia->timer_b.control;       break;
+    }
+    return 1;
+}
+
+
+// -------------------------------------------------
+// The CIAs are reset with the CPU
+// -------------------------------------------------
+void virtual_cia_reset() {
+  uint8_t i;
+
+    for (i=0; i<2; i++) {
+      memset(&virtual_cias[i], 0, sizeof(virtual_cia_state));
+      virtual_cias[i].timer_a.latch   = 0xFFFF;
+      virtual_cias[i].timer_a.counter = 0xFFFF;
+      virtual_cias[i].timer_b.latch   = 0xFFFF;
+      virtual_cias[i].timer_b.counter = 0xFFFF;
+      virtual_cias[i].last_cycle = phi2_cycles + internal_cycles;
+    }
+    return;
+}
+
+#endif // ENABLE_ACCELERATION
+
+#endif // VIRTUAL_CIA_H
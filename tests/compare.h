@@ -0,0 +1,167 @@
+// ============================================================================
+// MCL64 Host Tests - Random State and the ROM/Native Comparison
+// ----------------------------------------------------------------------------
+// compare_run() calls the ROM routine from a saved state, then the native
+// handler from the same state, and compares PC, A, X, Y, SP, the flags
+// (apart from B and the unused bit) and all memory except the stack below
+// SP and, when stack_floor is lowered, the stack page from stack_floor up.
+// ============================================================================
+
+#ifndef COMPARE_H
+#define COMPARE_H
+
+uint8_t   saved_RAM[65536];
+uint8_t   rom_RAM[65536];
+uint8_t   saved_a, saved_x, saved_y, saved_sp, saved_flags;
+uint16_t  stack_floor=0x100;          // First stack byte excluded from the compare
+uint8_t   decline_allowed=0;          // A declining handler is counted, not a mismatch
+uint8_t   mismatches_shown=0;
+
+inline uint8_t rb() { return rand() & 0xFF; }
+
+
+// -------------------------------------------------
+// Random zero page and registers, decimal mode clear
+// -------------------------------------------------
+void random_state() {
+  uint16_t address;
+
+    for (address=0x2; address<0x100; address++) internal_RAM[address] = rb();
+    register_a     = rb();
+    register_x     = rb();
+    register_y     = rb();
+    register_flags = (rb() & 0xC3) | 0x30 | ((rb() & 0x1) << 2);
+    register_sp    = 0x80 + rb()%0x70;
+    return;
+}
+
+
+// -------------------------------------------------
+// Random floats, with zero, tiny, huge and unnormalized values
+// -------------------------------------------------
+uint8_t random_exponent() {
+    switch (rand()%8) {
+      case 0:  return 0x0;
+      case 1:  return 0xFF - rand()%4;
+      case 2:  return 0x1 + rand()%4;
+      case 3:  return 0x81 + rand()%8 - 4;
+      default: return rb();
+    }
+}
+
+// FAC or ARG layout: exponent, four mantissa bytes, sign
+void random_float(uint8_t base) {
+  uint8_t i;
+  uint8_t kind = rand()%8;
+
+    internal_RAM[base] = random_exponent();
+    for (i=1; i<=4; i++) internal_RAM[base+i] = rb();
+    if (kind==0) for (i=1; i<=4; i++) internal_RAM[base+i] = 0xFF;
+    if (kind==1) for (i=2; i<=4; i++) internal_RAM[base+i] = 0x0;
+    if (kind<5)  internal_RAM[base+1] |= 0x80;                         // Normalized
+    internal_RAM[base+5] = rb();
+    if (rand()%4==0) internal_RAM[0x70] = 0x0;                         // Rounding byte
+    return;
+}
+
+// Packed float for the (A,Y) entries, in zero page, at $BF11 (0.5) or in RAM
+void random_operand() {
+  uint16_t address;
+  uint8_t  i;
+
+    switch (rand()%6) {
+      case 0:  address = 0x57 + rand()%10;     break;
+      case 1:  address = 0x5C;                 break;
+      case 2:  address = 0x61 + rand()%10;     break;
+      case 3:  address = 0xBF11;               break;
+      default: address = 0x2000 + rand()%0x6000;
+    }
+    if (address>0xFF && address<0xA000) {
+      internal_RAM[address] = random_exponent();
+      for (i=1; i<5; i++) internal_RAM[address+i] = rb();
+    }
+    register_a = address & 0xFF;
+    register_y = address >> 8;
+    return;
+}
+
+
+// -------------------------------------------------
+// Save and restore the whole machine state
+// -------------------------------------------------
+void save_state() {
+    memcpy(saved_RAM, internal_RAM, sizeof(internal_RAM));
+    saved_a = register_a;  saved_x = register_x;  saved_y = register_y;
+    saved_sp = register_sp;  saved_flags = register_flags;
+    return;
+}
+
+void restore_state() {
+    memcpy(internal_RAM, saved_RAM, sizeof(internal_RAM));
+    register_a = saved_a;  register_x = saved_x;  register_y = saved_y;
+    register_sp = saved_sp;  register_flags = saved_flags;
+    return;
+}
+
+
+// -------------------------------------------------
+// Run the ROM and the handler from the same state
+//  Return: 0 when both match and returned, 1 when both match at the error
+//          handler, 2 when the handler declined and decline_allowed is
+//          set, -1 on a mismatch or any other decline
+// -------------------------------------------------
+int compare_run(uint16_t entry, uint8_t (*handler)()) {
+  uint8_t  rom_a, rom_x, rom_y, rom_sp, rom_flags;
+  uint16_t rom_pc;
+  uint16_t return_address;
+  uint32_t address;
+  int32_t  first=-1;
+  uint8_t  result;
+  uint8_t  match;
+
+    save_state();
+    if (rom_call(entry)<0) return -1;
+    memcpy(rom_RAM, internal_RAM, sizeof(internal_RAM));
+    rom_a = register_a;  rom_x = register_x;  rom_y = register_y;
+    rom_sp = register_sp;  rom_flags = register_flags;  rom_pc = register_pc;
+    restore_state();
+
+    push((ROM_RETURN_ADDRESS-1) >> 8);
+    push((ROM_RETURN_ADDRESS-1) & 0xFF);
+    result = handler();
+    if (result==NATIVE_DECLINE) {
+      memcpy(internal_RAM, rom_RAM, sizeof(internal_RAM));
+      if (decline_allowed) return 2;
+      printf("entry %04X declined\n", entry);
+      return -1;
+    }
+    if (result==NATIVE_RTS) {
+      return_address  = pop();
+      return_address |= pop() << 8;
+      register_pc = return_address + 1;
+    }
+
+    match = (register_pc==rom_pc && register_a==rom_a && register_x==rom_x && register_y==rom_y &&
+             register_sp==rom_sp && ((register_flags ^ rom_flags) & 0xCF)==0);
+    for (address=0; address<0x10000; address++) {
+      if (address>=stack_floor && address<=(uint32_t)0x100+rom_sp) continue;
+      if (internal_RAM[address]!=rom_RAM[address]) {
+        match = 0;
+        first = address;
+        break;
+      }
+    }
+    if (match) return (rom_pc==ROM_ERROR_HANDLER);
+
+    if (mismatches_shown++<5) {
+      printf("entry %04X: pc %04X/%04X a %02X/%02X x %02X/%02X y %02X/%02X sp %02X/%02X p %02X/%02X",
+             entry, register_pc, rom_pc, register_a, rom_a, register_x, rom_x, register_y, rom_y,
+             register_sp, rom_sp, register_flags, rom_flags);
+      if (first>=0) printf(" first difference %04X %02X/%02X", first, internal_RAM[first], rom_RAM[first]);
+      printf("\n");
+    }
+    memcpy(internal_RAM, rom_RAM, sizeof(internal_RAM));
+    return -1;
+}
+
+#endif // COMPARE_H
@@ -0,0 +1,145 @@
+// ============================================================================
+// MCL64 Host Tests - 6502 Core over a Flat 64K Memory
+// ----------------------------------------------------------------------------
+// The opcodes of the sketch (opcodes.h, opcode_dispatch.h) run on
+// internal_RAM with BASIC_ROM and KERNAL_ROM copied in, so a ROM routine
+// can be called as with JSR and its result compared with a native handler.
+// Every address is internal at level 3 except the 6510 port, and writes
+// to the ROM areas are ignored.
+// ============================================================================
+
+#ifndef HOST_CORE_H
+#define HOST_CORE_H
+
+#include <stdint.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define ENABLE_ACCELERATION 1
+
+#define ROM_RETURN_ADDRESS    0x1000  // The JSR of rom_call() returns here
+#define ROM_ERROR_HANDLER     0xA437
+
+uint8_t   register_a, register_x, register_y, register_sp=0xFF, register_flags=0x34;
+uint16_t  register_pc, current_address, effective_address;
+uint8_t   current_p=0x37;
+uint8_t   internal_RAM[65536];
+uint8_t   next_instruction, ea_data, global_temp, last_access_internal_RAM, assert_sync;
+uint8_t   mode=3, accel_mode=3;
+uint16_t  fetch_address;
+void      (*write_hook)(uint16_t local_address)=0;   // Called after each write, e.g. for the index hooks of write_byte()
+uint64_t  rom_instructions=0;
+uint16_t  rom_exits[2]={ ROM_RETURN_ADDRESS, ROM_RETURN_ADDRESS };   // Where a routine continues instead of returning, e.g. NEXT
+
+
+// -------------------------------------------------
+// Bus interface of the sketch
+// -------------------------------------------------
+inline uint8_t rom_area(uint16_t local_address) {
+    return (local_address>=0xA000 && local_address<=0xBFFF) || local_address>=0xE000;
+}
+
+uint8_t read_byte(uint16_t local_address) {
+    current_address = local_address;
+    return internal_RAM[local_address];
+}
+
+void write_byte(uint16_t local_address, uint8_t local_write_data) {
+    if (!rom_area(local_address)) internal_RAM[local_address] = local_write_data;
+    if (write_hook) write_hook(local_address);
+    return;
+}
+
+void    start_write_byte(uint16_t local_address, uint8_t local_write_data) { write_byte(local_address, local_write_data); }
+void    finish_write_byte() {}
+void    start_read(uint32_t local_address) { fetch_address = local_address; }
+uint8_t finish_read_byte() { return internal_RAM[fetch_address]; }
+uint8_t internal_address_check(uint16_t local_address) { return (local_address<=0x0001) ? 0x0 : 0x3; }
+
+#define register_sp_fixed (0x0100 | register_sp)
+
+void push(uint8_t push_data) {
+    write_byte(register_sp_fixed, push_data);
+    register_sp = register_sp - 1;
+    return;
+}
+
+uint8_t pop() {
+    register_sp = register_sp + 1;
+    return read_byte(register_sp_fixed);
+}
+
+void Calc_Flags_NEGATIVE_ZERO(uint8_t local_data) {
+    register_flags = (register_flags & 0x7D) | (local_data & 0x80) | ((local_data==0) ? 0x02 : 0x00);
+    return;
+}
+
+uint16_t Sign_Extend16(uint16_t reg_data) {
+    return (reg_data&0x80) ? (reg_data|0xFF00) : (reg_data&0xFF);
+}
+
+void Begin_Fetch_Next_Opcode() {
+    register_pc++;
+    assert_sync = 1;
+    start_read(register_pc);
+    return;
+}
+
+void nmi_handler() {}
+
+void irq_handler(uint8_t) {
+    printf("BRK at %04X\n", register_pc);
+    exit(1);
+}
+
+#include "../MCL64/opcodes.h"
+#include "../MCL64/opcode_dispatch.h"
+
+#define CART_ROML_MAPPED      0
+#define CART_ROMH_MAPPED      0
+#define CART_ULTIMAX_MAPPED   0
+
+#include "../MCL64/basic_rom.h"
+#include "../MCL64/kernal_rom.h"
+
+
+// -------------------------------------------------
+// Clear memory and copy the ROMs in
+// -------------------------------------------------
+void load_roms() {
+    memset(internal_RAM, 0, sizeof(internal_RAM));
+    memcpy(internal_RAM+0xA000, BASIC_ROM, 0x2000);
+    memcpy(internal_RAM+0xE000, KERNAL_ROM, 0x2000);
+    return;
+}
+
+
+// -------------------------------------------------
+// Run the ROM routine at address as if called with JSR
+//  Return: 0 when it returned or reached one of rom_exits, 1 when it
+//          reached the error handler, -1 when it did not finish within
+//          limit instructions
+// -------------------------------------------------
+int rom_call(uint16_t address, uint32_t limit=50000000) {
+  uint32_t count=0;
+
+    push((ROM_RETURN_ADDRESS-1) >> 8);
+    push((ROM_RETURN_ADDRESS-1) & 0xFF);
+    register_pc = address;
+    start_read(register_pc);
+
+    while (register_pc!=ROM_RETURN_ADDRESS && register_pc!=ROM_ERROR_HANDLER &&
+           register_pc!=rom_exits[0] && register_pc!=rom_exits[1]) {
+      next_instruction = finish_read_byte();
+      execute_opcode(next_instruction);
+      if (++count>limit) {
+        printf("runaway pc=%04X\n", register_pc);
+        return -1;
+      }
+    }
+    rom_instructions += count;
+    return (register_pc==ROM_ERROR_HANDLER);
+}
+
+#endif // HOST_CORE_H
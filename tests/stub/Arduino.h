@@ -0,0 +1,3 @@
+// Host build stand-in for the Teensy core, enough for opcodes.h
+#pragma once
+#include <stdint.h>
@@ -0,0 +1,80 @@
+// ============================================================================
+// MCL64 Host Tests - basic_chrget.h
+// ----------------------------------------------------------------------------
+// CHRGET ($0073) and CHRGOT ($0079) against the KERNAL's CHRGET copied to
+// zero page, for random text of digits, spaces, ':', tokens, letters and
+// line ends, with TXTPTR often just below a page boundary.  With a byte of
+// the zero page copy other than TXTPTR patched, as a wedge would, the traps
+// must decline.
+// ============================================================================
+
+#include "host_core.h"
+#include "../MCL64/native_traps.h"
+#include "../MCL64/basic_float.h"
+#include "../MCL64/basic_convert.h"
+#include "../MCL64/basic_chrget.h"
+#include "compare.h"
+
+void basic_functions_register_traps() {}
+void basic_lines_register_traps() {}
+void basic_variables_register_traps() {}
+void basic_garbage_register_traps() {}
+void basic_loops_register_traps() {}
+void basic_memory_register_traps() {}
+
+#define TEXT_LENGTH     24
+
+
+// -------------------------------------------------
+// Random text with TXTPTR on it and CHRGET in zero page
+// -------------------------------------------------
+void random_text() {
+  const uint8_t characters[] = { ' ', ' ', ' ', ':', 0x00, '0', '5', '9', '/', ';', 'A', 0x99, 0xAB, 0xFF };
+  uint16_t address;
+  uint8_t  i;
+
+    memcpy(&internal_RAM[0x73], &KERNAL_ROM[0x03A2], 24);             // CHRGET as the KERNAL copies it at reset
+    address = (rand()%4==0) ? 0x08FF - rand()%4 : 0x0200 + rand()%0x600;
+    for (i=0; i<TEXT_LENGTH; i++) {
+      internal_RAM[address+i] = (rand()%2) ? characters[rand() % sizeof(characters)] : rb();
+    }
+    internal_RAM[0x7A] = address & 0xFF;
+    internal_RAM[0x7B] = address >> 8;
+    return;
+}
+
+int main(int argc, char **argv) {
+  long runs = (argc>1) ? atol(argv[1]) : 100000;
+  long bad=0;
+  long i;
+  uint8_t e;
+  uint8_t offset;
+
+    load_roms();
+    srand(7);
+
+    for (e=0; e<2; e++) {
+      for (i=0; i<runs; i++) {
+        random_state();
+        random_text();
+        if (compare_run(e ? 0x0079 : 0x0073, e ? native_chrgot : native_chrget)<0) bad++;
+      }
+      printf("%04X: %ld runs\n", e ? 0x0079 : 0x0073, runs);
+    }
+
+    for (i=0; i<runs/10; i++) {                                        // A wedge patched the copy
+      random_state();
+      random_text();
+      do offset = rand()%24; while (offset==7 || offset==8);          // Not TXTPTR, the operand of the LDA
+      internal_RAM[0x73 + offset] ^= 1 + rand()%0xFF;
+      save_state();
+      if (native_chrget()!=NATIVE_DECLINE || native_chrgot()!=NATIVE_DECLINE) {
+        printf("0073 ran a patched CHRGET\n");
+        bad++;
+      }
+      restore_state();
+    }
+    printf("patched: %ld runs\n", runs/10);
+    printf("mismatches=%ld\n", bad);
+    return (bad!=0);
+}
@@ -0,0 +1,154 @@
+// ============================================================================
+// MCL64 Host Tests - basic_convert.h
+// ----------------------------------------------------------------------------
+// FIN against BASIC_ROM for random literals with signs, spaces, points,
+// exponents, the + and - tokens in the exponent and the characters that
+// end a number, read through the KERNAL's CHRGET copied to zero page.
+// FOUT and its $BDDF entry against the ROM for random normalized values,
+// mostly in the range printed without the E format, and buffer offsets.
+// The string buffer at $0100 is compared along with the rest of memory.
+// ============================================================================
+
+#include "host_core.h"
+#include "../MCL64/native_traps.h"
+#include "../MCL64/basic_float.h"
+#include "../MCL64/basic_convert.h"
+#include "compare.h"
+
+void basic_functions_register_traps() {}
+void basic_lines_register_traps() {}
+void basic_variables_register_traps() {}
+void basic_garbage_register_traps() {}
+void basic_loops_register_traps() {}
+void basic_memory_register_traps() {}
+void basic_chrget_register_traps() {}
+
+#define LITERAL_MAX     64
+
+
+// -------------------------------------------------
+// Random numeric literal, terminated as BASIC text would be
+// -------------------------------------------------
+uint8_t literal[LITERAL_MAX];
+uint8_t literal_length;
+
+void literal_add(uint8_t c)         { if (literal_length<LITERAL_MAX-1) literal[literal_length++] = c; }
+void literal_space()                { if (rand()%8==0) literal_add(' '); }
+void literal_digits(uint8_t count)  { while (count--) literal_add('0' + rand()%10); }
+
+void random_literal() {
+  const uint8_t terminators[] = { 0x00, ':', ',', ')', ' ', 'A', '"' };
+  uint8_t kind;
+
+    literal_length = 0;
+    kind = rand()%10;
+    if (kind==0) literal_add('-');
+    if (kind==1) literal_add('+');
+    literal_space();
+    literal_digits((rand()%4==0) ? rand()%25 : rand()%10);
+    literal_space();
+    if (rand()%3==0) {
+      literal_add('.');
+      literal_digits(rand()%12);
+      if (rand()%10==0) literal_add('.');
+    }
+    if (rand()%3==0) {
+      literal_add('E');
+      literal_space();
+      switch (rand()%6) {
+        case 0:  literal_add('-');   break;
+        case 1:  literal_add('+');   break;
+        case 2:  literal_add(0xAB);  break;                             // - token
+        case 3:  literal_add(0xAA);  break;                             // + token
+      }
+      literal_digits((rand()%4==0) ? rand()%5 : 1+rand()%2);
+    }
+    literal_add(terminators[rand() % sizeof(terminators)]);
+    return;
+}
+
+
+// -------------------------------------------------
+// Place the literal in RAM with TXTPTR on its first character, and A and
+// the flags as CHRGOT leaves them
+// -------------------------------------------------
+void place_literal() {
+  uint16_t address;
+  uint8_t  i;
+  uint8_t  c;
+
+    memcpy(&internal_RAM[0x73], &KERNAL_ROM[0x03A2], 24);             // CHRGET as the KERNAL copies it at reset
+    address = (rand()%8==0) ? 0x08FF - rand()%4 : 0x0200 + rand()%0x40;
+    for (i=0; i<literal_length; i++) internal_RAM[address+i] = literal[i];
+    internal_RAM[address+literal_length] = 0x0;
+    while (internal_RAM[address]==' ') address++;
+    internal_RAM[0x7A] = address & 0xFF;
+    internal_RAM[0x7B] = address >> 8;
+
+    c = internal_RAM[address];
+    register_a     = c;
+    register_flags = (register_flags & 0x7C) | (c & 0x80) | ((c==0) ? 0x02 : 0x00) | ((c>=0x3A || c<0x30) ? 0x01 : 0x00);
+    return;
+}
+
+
+// -------------------------------------------------
+// Random normalized FAC for FOUT
+// -------------------------------------------------
+void random_fout_value() {
+  uint16_t address;
+
+    random_float(0x61);
+    if (rand()%4) internal_RAM[0x61] = 0x60 + rand()%0x50;            // Mostly printed without E
+    if (rand()%8==0) {                                                 // Whole numbers
+      internal_RAM[0x61] = 0x81 + rand()%30;
+      internal_RAM[0x63] = 0x0;
+      internal_RAM[0x64] = 0x0;
+      internal_RAM[0x65] = 0x0;
+    }
+    internal_RAM[0x62] |= 0x80;
+    for (address=0x100; address<0x130; address++) internal_RAM[address] = rb();
+    return;
+}
+
+int main(int argc, char **argv) {
+  long runs = (argc>1) ? atol(argv[1]) : 100000;
+  long bad=0;
+  long errors;
+  long i;
+  uint8_t e;
+  int result;
+
+    load_roms();
+    srand(3);
+    stack_floor = 0x130;                                               // $0100-$012F is the FOUT buffer
+
+    errors = 0;
+    for (i=0; i<runs; i++) {
+      random_state();
+      random_float(0x61);
+      random_float(0x69);
+      random_literal();
+      place_literal();
+      result = compare_run(0xBCF3, native_fin);
+      if (result<0) bad++;
+      if (result==1) errors++;
+    }
+    printf("BCF3: %ld runs, %ld reached the error handler\n", runs, errors);
+
+    for (e=0; e<2; e++) {
+      errors = 0;
+      for (i=0; i<runs; i++) {
+        random_state();
+        random_fout_value();
+        random_float(0x69);
+        if (e==1) register_y = rand()%3;
+        result = compare_run(e ? 0xBDDF : 0xBDDD, e ? native_fout_y : native_fout);
+        if (result<0) bad++;
+        if (result==1) errors++;
+      }
+      printf("%04X: %ld runs, %ld reached the error handler\n", e ? 0xBDDF : 0xBDDD, runs, errors);
+    }
+    printf("mismatches=%ld\n", bad);
+    return (bad!=0);
+}
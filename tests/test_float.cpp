@@ -0,0 +1,98 @@
+// ============================================================================
+// MCL64 Host Tests - basic_float.h
+// ----------------------------------------------------------------------------
+// FADD, FSUB, FMULT and FDIV, their (A,Y) memory entries and their ARG
+// entries, against BASIC_ROM for random FAC, ARG and operands.  The ARG
+// entries are mostly given the Z and N flags of LDA $61 as their callers
+// leave them.  MULDIV is also compared on its own, as EXP uses the flags
+// it returns with; only exponents that return normally are used.
+// ============================================================================
+
+#include "host_core.h"
+#include "../MCL64/native_traps.h"
+#include "../MCL64/basic_float.h"
+#include "compare.h"
+
+void basic_functions_register_traps() {}
+void basic_convert_register_traps() {}
+void basic_lines_register_traps() {}
+void basic_variables_register_traps() {}
+void basic_garbage_register_traps() {}
+void basic_loops_register_traps() {}
+void basic_memory_register_traps() {}
+void basic_chrget_register_traps() {}
+
+#define ENTRY_ARG       0x0
+#define ENTRY_MEMORY    0x1
+#define ENTRY_FLAGS     0x2
+#define ENTRY_MULDIV    0x3
+
+uint8_t native_muldiv() {
+    if (!fp_begin()) return NATIVE_DECLINE;
+    fp_muldiv();
+    return fp_end();
+}
+
+struct test_entry {
+  uint16_t  address;
+  uint8_t   (*handler)();
+  uint8_t   kind;
+};
+
+const test_entry entries[] = {
+  { 0xB850, native_fsub,   ENTRY_MEMORY },
+  { 0xB853, native_fsubt,  ENTRY_ARG    },
+  { 0xB867, native_fadd,   ENTRY_MEMORY },
+  { 0xB86A, native_faddt,  ENTRY_FLAGS  },
+  { 0xBA28, native_fmult,  ENTRY_MEMORY },
+  { 0xBA2B, native_fmultt, ENTRY_FLAGS  },
+  { 0xBB0F, native_fdiv,   ENTRY_MEMORY },
+  { 0xBB12, native_fdivt,  ENTRY_FLAGS  },
+  { 0xBAB7, native_muldiv, ENTRY_MULDIV },
+};
+
+
+// MULDIV pulls its caller's return address when FAC becomes zero
+uint8_t muldiv_returns() {
+  uint16_t sum = internal_RAM[0x69] + internal_RAM[0x61];
+
+    if (internal_RAM[0x69]==0) return 0;
+    if (sum<0x100) return (sum&0x80)!=0;
+    return 1;
+}
+
+int main(int argc, char **argv) {
+  long runs = (argc>1) ? atol(argv[1]) : 100000;
+  long bad=0;
+  long errors;
+  long i;
+  uint8_t e;
+  int result;
+
+    load_roms();
+    srand(1);
+    for (e=0; e<sizeof(entries)/sizeof(test_entry); e++) {
+      errors = 0;
+      for (i=0; i<runs; i++) {
+        do {
+          random_state();
+          random_float(0x61);
+          random_float(0x69);
+          if (entries[e].kind==ENTRY_MULDIV && rand()%2) {               // Mostly in range
+            internal_RAM[0x61] = 0x40 + rand()%0x80;
+            internal_RAM[0x69] = 0x40 + rand()%0x80;
+          }
+        } while (entries[e].kind==ENTRY_MULDIV && !muldiv_returns());
+        if (entries[e].kind==ENTRY_MEMORY) random_operand();
+        if (entries[e].kind==ENTRY_FLAGS && rand()%8) {
+          register_flags = (register_flags & 0x7D) | ((internal_RAM[0x61]==0) ? 0x02 : 0x00) | (internal_RAM[0x61] & 0x80);
+        }
+        result = compare_run(entries[e].address, entries[e].handler);
+        if (result<0) bad++;
+        if (result==1) errors++;
+      }
+      printf("%04X: %ld runs, %ld reached the error handler\n", entries[e].address, runs, errors);
+    }
+    printf("mismatches=%ld\n", bad);
+    return (bad!=0);
+}
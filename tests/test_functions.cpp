@@ -0,0 +1,143 @@
+// ============================================================================
+// MCL64 Host Tests - basic_functions.h
+// ----------------------------------------------------------------------------
+// SIN, COS, TAN, ATN, LOG, EXP, SQR, the power operator and the POLY/POLYX
+// series evaluators against the ROMs.  Every entry first runs for each FAC
+// exponent, both signs and edge mantissas, then for random FAC and ARG
+// mostly near 1.  POLY and POLYX are given the ROM's own series tables and
+// random ones, including a table that crosses a page.
+// ============================================================================
+
+#include "host_core.h"
+#include "../MCL64/native_traps.h"
+#include "../MCL64/basic_float.h"
+#include "../MCL64/basic_functions.h"
+#include "compare.h"
+
+void basic_convert_register_traps() {}
+void basic_lines_register_traps() {}
+void basic_variables_register_traps() {}
+void basic_garbage_register_traps() {}
+void basic_loops_register_traps() {}
+void basic_memory_register_traps() {}
+void basic_chrget_register_traps() {}
+
+#define ENTRY_FAC       0x0
+#define ENTRY_POWER     0x1           // FPWRT, entered with the flags of LDA $61
+#define ENTRY_SERIES    0x2           // POLY and POLYX, series table at (A,Y)
+
+struct test_entry {
+  uint16_t  address;
+  uint8_t   (*handler)();
+  uint8_t   kind;
+};
+
+const test_entry entries[] = {
+  { 0xE264, native_cos,   ENTRY_FAC    },
+  { 0xE26B, native_sin,   ENTRY_FAC    },
+  { 0xE2B4, native_tan,   ENTRY_FAC    },
+  { 0xE30E, native_atn,   ENTRY_FAC    },
+  { 0xB9EA, native_log,   ENTRY_FAC    },
+  { 0xBFED, native_exp,   ENTRY_FAC    },
+  { 0xBF71, native_sqr,   ENTRY_FAC    },
+  { 0xBF7B, native_fpwrt, ENTRY_POWER  },
+  { 0xE043, native_polyx, ENTRY_SERIES },
+  { 0xE059, native_poly,  ENTRY_SERIES },
+};
+
+const uint16_t series_tables[] = { 0xE2EF, 0xB9C1, 0xBFC4, 0xE33E, 0xE08D };
+
+const uint32_t edge_mantissas[] = { 0x80000000, 0xFFFFFFFF, 0x80000001, 0xC90FDAA2 };
+
+
+// Most arguments are near 1, where the series do their work
+void realistic_float(uint8_t base) {
+    if (rand()%4) {
+      internal_RAM[base]    = 0x60 + rand()%0x40;
+      internal_RAM[base+1] |= 0x80;
+    }
+    return;
+}
+
+void set_fac(uint8_t exponent, uint32_t mantissa, uint8_t sign) {
+    internal_RAM[0x61] = exponent;
+    internal_RAM[0x62] = mantissa >> 24;
+    internal_RAM[0x63] = mantissa >> 16;
+    internal_RAM[0x64] = mantissa >> 8;
+    internal_RAM[0x65] = mantissa;
+    internal_RAM[0x66] = sign;
+    internal_RAM[0x70] = 0x0;
+    return;
+}
+
+// Registers and flags the entry is called with
+void set_entry_state(uint8_t kind) {
+  uint16_t table;
+  uint8_t  k;
+
+    if (kind==ENTRY_POWER && rand()%8) {
+      register_flags = (register_flags & 0x7D) | ((internal_RAM[0x61]==0) ? 0x02 : 0x00) | (internal_RAM[0x61] & 0x80);
+    }
+    if (kind==ENTRY_SERIES) {
+      table = series_tables[rand() % (sizeof(series_tables)/sizeof(uint16_t))];
+      if (rand()%3==0) {                                               // Random table, sometimes across a page
+        table = 0x3000 + rand()%0x100;
+        internal_RAM[table] = rand()%4;
+        for (k=1; k<30; k++) internal_RAM[table+k] = rb();
+        if (rand()%2) table = 0x30FF;
+      }
+      register_a = table & 0xFF;
+      register_y = table >> 8;
+    }
+    return;
+}
+
+int main(int argc, char **argv) {
+  long runs = (argc>1) ? atol(argv[1]) : 20000;
+  long bad=0;
+  long errors;
+  long count;
+  long i;
+  uint16_t exponent;
+  uint8_t  e, m, sign;
+  int result;
+
+    load_roms();
+    srand(2);
+    for (e=0; e<sizeof(entries)/sizeof(test_entry); e++) {
+      errors = 0;
+      count  = 0;
+
+      for (exponent=0; exponent<0x100; exponent++) {                   // Every exponent
+        for (sign=0; sign<2; sign++) {
+          for (m=0; m<sizeof(edge_mantissas)/sizeof(uint32_t); m++) {
+            random_state();
+            random_float(0x69);
+            set_fac(exponent, edge_mantissas[m], sign ? 0xFF : 0x00);
+            set_entry_state(entries[e].kind);
+            result = compare_run(entries[e].address, entries[e].handler);
+            if (result<0) bad++;
+            if (result==1) errors++;
+            count++;
+          }
+        }
+      }
+
+      for (i=0; i<runs; i++) {                                         // Random arguments
+        random_state();
+        random_float(0x61);
+        random_float(0x69);
+        realistic_float(0x61);
+        realistic_float(0x69);
+        if (rand()%4==0) internal_RAM[0x61] = 0x80 + rand()%3;
+        set_entry_state(entries[e].kind);
+        result = compare_run(entries[e].address, entries[e].handler);
+        if (result<0) bad++;
+        if (result==1) errors++;
+        count++;
+      }
+      printf("%04X: %ld runs, %ld reached the error handler\n", entries[e].address, count, errors);
+    }
+    printf("mismatches=%ld\n", bad);
+    return (bad!=0);
+}
@@ -0,0 +1,199 @@
+// ============================================================================
+// MCL64 Host Tests - basic_garbage.h
+// ----------------------------------------------------------------------------
+// GARBAG ($B526) against BASIC_ROM for random variable areas: simple string
+// variables among the other kinds, string arrays among numeric ones, and
+// temporary descriptors.  Strings are allocated down from MEMSIZ with gaps
+// and the descriptors point at them, with many sharing a string.  Shared
+// strings with the same pointer and different lengths, and with the same
+// pointer and length, exercise the order among equal pointers that the
+// sort has to reproduce.  Pointers into the program text, above MEMSIZ and
+// to arbitrary addresses between STREND and MEMSIZ are mixed in.  The
+// trap may decline; declines are counted and the runs where it does not
+// are compared.  With $53 not 3 the ROM steps through the temporary
+// descriptors forever, so there the trap must decline and the ROM is not
+// run.
+// ============================================================================
+
+#include "host_core.h"
+#include "../MCL64/native_traps.h"
+#include "../MCL64/basic_garbage.h"
+#include "compare.h"
+
+void basic_float_register_traps() {}
+void basic_functions_register_traps() {}
+void basic_convert_register_traps() {}
+void basic_lines_register_traps() {}
+void basic_variables_register_traps() {}
+void basic_loops_register_traps() {}
+void basic_memory_register_traps() {}
+void basic_chrget_register_traps() {}
+
+#define MEMSIZ          0xA000
+#define STRINGS_MAX     300
+
+uint16_t  string_pointer[STRINGS_MAX];
+uint8_t   string_length[STRINGS_MAX];
+uint8_t   string_used[STRINGS_MAX];
+uint16_t  string_count;
+uint16_t  strend;
+uint32_t  shared_ties=0;              // Descriptors given a pointer already used
+
+
+// -------------------------------------------------
+// Allocate strings down from MEMSIZ, leaving room for the variables
+// -------------------------------------------------
+void allocate_strings(uint16_t count, uint16_t lowest) {
+  uint16_t top = MEMSIZ;
+  uint16_t gap;
+  uint8_t  length;
+  uint8_t  i;
+
+    string_count = 0;
+    while (string_count<count) {
+      length = 1 + rand() % ((rand()%4) ? 16 : 255);
+      gap    = (rand()%3==0) ? rand()%20 : 0;
+      if (top < lowest + length + gap) break;
+      top -= length + gap;
+      string_pointer[string_count] = top;
+      string_length[string_count]  = length;
+      string_used[string_count]    = 0;
+      for (i=0; i<length; i++) internal_RAM[top+i] = rb();
+      string_count++;
+    }
+    return;
+}
+
+
+// -------------------------------------------------
+// Write a descriptor
+// -------------------------------------------------
+void random_descriptor(uint16_t address) {
+  uint16_t pointer;
+  uint8_t  length;
+  uint16_t i;
+
+    length = (rand()%8==0) ? 0 : 1 + rand() % ((rand()%4) ? 20 : 255);
+    switch (rand()%20) {
+      case 0:  pointer = 0x0810 + rand()%0x100;                  break;   // Literal in the program text
+      case 1:  pointer = strend + rand()%(MEMSIZ-strend);        break;   // Anywhere, may overlap a string
+      case 2:  pointer = MEMSIZ + rand()%0x100;                  break;   // Above MEMSIZ
+      default:
+        if (string_count==0) { pointer = 0x0810;  break; }
+        i       = rand() % string_count;
+        pointer = string_pointer[i];
+        length  = string_length[i];
+        if (rand()%4==0) length = 1 + rand()%length;                   // Same pointer, shorter
+        if (string_used[i]) shared_ties++;
+        string_used[i] = 1;
+    }
+    internal_RAM[address]   = length;
+    internal_RAM[address+1] = pointer;
+    internal_RAM[address+2] = pointer >> 8;
+    return;
+}
+
+
+// -------------------------------------------------
+// Simple variables, arrays and temporaries
+//  Return: 0 when the ROM would not finish
+// -------------------------------------------------
+uint8_t random_variables() {
+  uint16_t vartab = 0x0900 + rand()%0x400;
+  uint16_t arytab;
+  uint16_t address = vartab;
+  uint16_t variables = rand() % ((rand()%4) ? 40 : 200);
+  uint16_t arrays    = rand() % 5;
+  uint16_t strings   = (rand()%4==0) ? rand()%STRINGS_MAX : rand()%100;
+  uint16_t size, elements, i, k;
+  uint8_t  kind, element_size, name1, name2, temporaries;
+
+    strend = vartab + variables*7 + arrays*(7+3*60) + 16;              // Highest the variables can reach
+    allocate_strings(strings, strend + 0x100);
+
+    for (i=0; i<variables; i++) {
+      kind  = rand()%4;                                                // Float, integer, string, function
+      name1 = 'A' + rand()%26;
+      name2 = 'A' + rand()%26;
+      if (kind==1) { name1 |= 0x80;  name2 |= 0x80; }
+      if (kind==2) name2 |= 0x80;
+      if (kind==3) name1 |= 0x80;
+      internal_RAM[address]   = name1;
+      internal_RAM[address+1] = name2;
+      for (k=2; k<7; k++) internal_RAM[address+k] = rb();
+      if (kind==2) random_descriptor(address+2);
+      address += 7;
+    }
+    arytab = address;
+
+    for (i=0; i<arrays; i++) {
+      kind  = rand()%3;                                                // Float, integer, string
+      name1 = 'A' + rand()%26;
+      name2 = 'A' + rand()%26;
+      if (kind==1) { name1 |= 0x80;  name2 |= 0x80; }
+      if (kind==2) name2 |= 0x80;
+      element_size = (kind==1) ? 2 : ((kind==2) ? 3 : 5);
+      elements = 1 + rand()%60;
+      size = 5 + 2 + elements*element_size;                            // One dimension
+      internal_RAM[address]   = name1;
+      internal_RAM[address+1] = name2;
+      internal_RAM[address+2] = size;
+      internal_RAM[address+3] = size >> 8;
+      internal_RAM[address+4] = 1;
+      internal_RAM[address+5] = elements >> 8;
+      internal_RAM[address+6] = elements;
+      for (k=0; k<elements; k++) {
+        if (kind==2) random_descriptor(address + 7 + 3*k);
+        else for (name1=0; name1<element_size; name1++) internal_RAM[address + 7 + element_size*k + name1] = rb();
+      }
+      address += size;
+    }
+    strend = address;
+
+    internal_RAM[0x2D] = vartab;   internal_RAM[0x2E] = vartab >> 8;
+    internal_RAM[0x2F] = arytab;   internal_RAM[0x30] = arytab >> 8;
+    internal_RAM[0x31] = strend;   internal_RAM[0x32] = strend >> 8;
+    internal_RAM[0x37] = MEMSIZ & 0xFF;
+    internal_RAM[0x38] = MEMSIZ >> 8;
+
+    temporaries = rand()%4;
+    internal_RAM[0x16] = 0x19 + 3*temporaries;
+    for (i=0; i<temporaries; i++) random_descriptor(0x19 + 3*i);
+    if (rand()%10) internal_RAM[0x53] = 0x3;                          // As the ROM leaves it
+    return (temporaries==0 || internal_RAM[0x53]==0x3);
+}
+
+int main(int argc, char **argv) {
+  long runs = (argc>1) ? atol(argv[1]) : 20000;
+  long bad=0;
+  long declined=0;
+  long i;
+  int result;
+  uint8_t rom_finishes;
+
+    load_roms();
+    srand(4);
+    decline_allowed = 1;
+    for (i=0; i<runs; i++) {
+      memset(internal_RAM+0x2, 0, MEMSIZ-0x2);
+      random_state();
+      rom_finishes = random_variables();
+      if (rom_finishes) {
+        result = compare_run(0xB526, native_garbag);
+        if (result<0)  bad++;
+        if (result==2) declined++;
+      }
+      else {
+        save_state();
+        if (native_garbag()!=NATIVE_DECLINE) {
+          printf("B526 ran with $53=%02X\n", internal_RAM[0x53]);
+          bad++;
+        }
+        else declined++;
+        restore_state();
+      }
+    }
+    printf("B526: %ld runs, %ld declined, %u descriptors sharing a pointer\n", runs, declined, (unsigned)shared_ties);
+    printf("mismatches=%ld\n", bad);
+    return (bad!=0);
+}
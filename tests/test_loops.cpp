@@ -0,0 +1,168 @@
+// ============================================================================
+// MCL64 Host Tests - basic_loops.h
+// ----------------------------------------------------------------------------
+// NEXT from $AD27 and FNDFOR against BASIC_ROM for random stacks of up to
+// four FOR frames over eight loop variables.  NEXT is given no variable
+// (plain NEXT, innermost loop), the variable of one of the frames (nested
+// loops, dropping the inner frames) or a variable without a frame.  STEP
+// and the limit are mostly small whole numbers, some limits equal the
+// variable, and the STEP sign byte is sometimes not the sign of STEP.
+// The ROM runs until NEWSTT ($A7AE), the end of the loop ($AD7D) or the
+// error handler.  When the trap declines the ROM must raise NEXT WITHOUT
+// FOR.
+// ============================================================================
+
+#include "host_core.h"
+#include "../MCL64/native_traps.h"
+#include "../MCL64/basic_float.h"
+#include "../MCL64/basic_loops.h"
+#include "compare.h"
+
+void basic_functions_register_traps() {}
+void basic_convert_register_traps() {}
+void basic_lines_register_traps() {}
+void basic_variables_register_traps() {}
+void basic_garbage_register_traps() {}
+void basic_memory_register_traps() {}
+void basic_chrget_register_traps() {}
+
+#define LOOP_VARIABLES      8
+#define ERROR_NEXT_WITHOUT_FOR  0x0A
+
+uint16_t  loop_variables[LOOP_VARIABLES];
+uint8_t   frame_count;
+
+
+// -------------------------------------------------
+// Packed float, often a small whole number
+// -------------------------------------------------
+void random_loop_float(uint16_t address) {
+  int      value;
+  uint8_t  sign;
+  uint8_t  exponent;
+  uint32_t mantissa;
+  uint8_t  i;
+
+    if (rand()%3==0) {
+      value = rand()%21 - 10;
+      if (value==0) {
+        for (i=0; i<5; i++) internal_RAM[address+i] = 0x0;
+        return;
+      }
+      sign  = (value<0);
+      value = abs(value);
+      for (exponent=0; (1<<exponent)<=value; exponent++) ;
+      mantissa = (uint32_t)value << (32-exponent);
+      internal_RAM[address]   = 0x80 + exponent;
+      internal_RAM[address+1] = ((mantissa>>24) & 0x7F) | (sign<<7);
+      internal_RAM[address+2] = mantissa >> 16;
+      internal_RAM[address+3] = mantissa >> 8;
+      internal_RAM[address+4] = mantissa;
+      return;
+    }
+    internal_RAM[address] = random_exponent();
+    for (i=1; i<5; i++) internal_RAM[address+i] = rb();
+    if (rand()%2) internal_RAM[address] = 0x78 + rand()%16;
+    return;
+}
+
+
+// -------------------------------------------------
+// FOR frames from $0101+frames up, then A/Y naming the variable of NEXT
+// -------------------------------------------------
+void build_frames(uint16_t frames) {
+  uint16_t frame = frames;
+  uint16_t variable;
+  uint8_t  i;
+
+    random_state();
+    register_sp = 0x60 + rand()%0x40;
+    frame += 0x0101 + register_sp;
+
+    for (i=0; i<LOOP_VARIABLES; i++) {
+      loop_variables[i] = 0x2000 + 7*i + 2;
+      random_loop_float(loop_variables[i]);
+    }
+
+    frame_count = rand()%5;
+    for (i=0; i<frame_count && frame+FOR_FRAME_SIZE<0x1FF; i++) {
+      variable = loop_variables[rand()%LOOP_VARIABLES];
+      internal_RAM[frame]   = FOR_FRAME_MARKER;
+      internal_RAM[frame+1] = variable;
+      internal_RAM[frame+2] = variable >> 8;
+      random_loop_float(frame+3);                                      // STEP and its sign
+      if (rand()%4==0) internal_RAM[frame+8] = rb();
+      else internal_RAM[frame+8] = (internal_RAM[frame+3]==0) ? 0x00 : ((internal_RAM[frame+4]&0x80) ? 0xFF : 0x01);
+      if (rand()%3==0) memcpy(&internal_RAM[frame+9], &internal_RAM[variable], 5);   // Limit equal to the variable
+      else random_loop_float(frame+9);
+      for (variable=14; variable<FOR_FRAME_SIZE; variable++) internal_RAM[frame+variable] = rb();
+      frame += FOR_FRAME_SIZE;
+    }
+    frame_count = i;
+    internal_RAM[frame] = (rand()%3) ? 0x8D : rb();                   // GOSUB frame or anything
+
+    switch (rand()%4) {
+      case 0:                                                          // Plain NEXT
+        register_a = (rand()%2) ? 0x00 : 0x3A;
+        register_y = 0x0;
+        return;
+      case 1:                                                          // Any variable, may have no frame
+        variable = loop_variables[rand()%LOOP_VARIABLES];
+        break;
+      default:                                                         // The variable of one of the frames
+        frame = frames + 0x0101 + register_sp + FOR_FRAME_SIZE*((frame_count!=0) ? rand()%frame_count : 0);
+        variable = internal_RAM[frame+1] | (internal_RAM[frame+2]<<8);
+        if (frame_count==0) variable = loop_variables[0];
+    }
+    register_a = variable & 0xFF;
+    register_y = variable >> 8;
+    return;
+}
+
+int main(int argc, char **argv) {
+  long runs = (argc>1) ? atol(argv[1]) : 100000;
+  long bad=0;
+  long declined=0, looped=0, ended=0, errors=0;
+  long i;
+  int result;
+
+    load_roms();
+    srand(5);
+    rom_exits[0] = 0xA7AE;                                             // NEWSTT, the next pass
+    rom_exits[1] = 0xAD7D;                                             // The loop ended
+
+    for (i=0; i<runs; i++) {
+      build_frames(0);                                                 // The pushed return address is NEXT's
+      save_state();
+      push((ROM_RETURN_ADDRESS-1) >> 8);
+      push((ROM_RETURN_ADDRESS-1) & 0xFF);
+      if (native_next()==NATIVE_DECLINE) {
+        restore_state();
+        declined++;
+        if (rom_call(0xAD27)!=1 || register_x!=ERROR_NEXT_WITHOUT_FOR) {
+          printf("AD27 declined, the ROM continued at %04X with X=%02X\n", register_pc, register_x);
+          bad++;
+        }
+        continue;
+      }
+      restore_state();
+      result = compare_run(0xAD27, native_next);
+      if (result<0) bad++;
+      else if (result==1)              errors++;
+      else if (register_pc==0xA7AE)    looped++;
+      else                             ended++;
+    }
+    printf("AD27: %ld runs, %ld next pass, %ld loop ended, %ld reached the error handler, %ld declined\n", runs, looped, ended, errors, declined);
+
+    rom_exits[0] = ROM_RETURN_ADDRESS;
+    rom_exits[1] = ROM_RETURN_ADDRESS;
+    for (i=0; i<runs; i++) {
+      build_frames(2);                                                 // NEXT's return address, then FNDFOR's
+      internal_RAM[0x49] = register_a;
+      internal_RAM[0x4A] = register_y;
+      if (compare_run(0xA38A, native_fndfor)<0) bad++;
+    }
+    printf("A38A: %ld runs\n", runs);
+    printf("mismatches=%ld\n", bad);
+    return (bad!=0);
+}
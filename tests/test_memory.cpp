@@ -0,0 +1,112 @@
+// ============================================================================
+// MCL64 Host Tests - basic_memory.h
+// ----------------------------------------------------------------------------
+// BLTU ($A3BF) against BASIC_ROM for random blocks, with the carry and
+// overflow flags of the final SBC and A, X and Y on return compared along
+// with memory.  Each case is run in turn:
+//  empty block               - length 0
+//  whole pages               - length a multiple of 256, so the low byte is 0
+//  short and long blocks     - any length below 256 and up to 12K
+//  overlapping, moved up     - the destination a little above the source
+//  overlapping, moved down   - the destination a little below the source
+//  in place                  - source and destination equal
+// Blocks that cross into the ROM areas are copied through read_byte() and
+// write_byte(), the rest with memmove().  A block whose end is below its
+// start must be declined.
+// ============================================================================
+
+#include "host_core.h"
+#include "../MCL64/native_traps.h"
+#include "../MCL64/basic_lines.h"
+#include "../MCL64/basic_variables.h"
+#include "../MCL64/basic_memory.h"
+#include "compare.h"
+
+void basic_float_register_traps() {}
+void basic_functions_register_traps() {}
+void basic_convert_register_traps() {}
+void basic_garbage_register_traps() {}
+void basic_loops_register_traps() {}
+void basic_chrget_register_traps() {}
+
+#define CASE_EMPTY          0
+#define CASE_PAGES          1
+#define CASE_SHORT          2
+#define CASE_LONG           3
+#define CASE_UP             4
+#define CASE_DOWN           5
+#define CASE_IN_PLACE       6
+#define CASE_WRAP           7
+#define CASES               8
+
+const char *case_names[CASES] = { "empty", "whole pages", "short", "long", "overlapping up",
+                                  "overlapping down", "in place", "wrapping" };
+
+
+// -------------------------------------------------
+// Set $5F/$60, $5A/$5B and $58/$59 for the case
+//  Return: 0 when the block does not fit in memory
+// -------------------------------------------------
+uint8_t random_block(uint8_t kind) {
+  uint16_t source, length, destination;
+  uint16_t source_end, destination_end;
+
+    source = (rand()%3) ? 0x0800 + rand()%0x5000 : 0x0400 + rand()%0xB000;
+    switch (kind) {
+      case CASE_EMPTY:  length = 0x0;                     break;
+      case CASE_PAGES:  length = 0x100 * (1 + rand()%8);  break;
+      case CASE_SHORT:  length = 1 + rand()%0xFF;         break;
+      case CASE_WRAP:   length = 0xFFFF - rand()%5;       break;
+      default:          length = rand()%0x3000;
+    }
+    switch (kind) {
+      case CASE_UP:        destination = source + 1 + rand()%300;     break;
+      case CASE_DOWN:      destination = source - 1 - rand()%300;     break;
+      case CASE_IN_PLACE:  destination = source;                      break;
+      default:             destination = 0x0800 + rand()%0x6000;
+    }
+    if (destination<0x300) destination = 0x300 + rb();
+
+    if (kind!=CASE_WRAP && ((uint32_t)source+length>0xFFFF || (uint32_t)destination+length>0xFFFF)) return 0;
+    source_end      = source + length;
+    destination_end = destination + length;
+    internal_RAM[0x5F] = source;           internal_RAM[0x60] = source >> 8;
+    internal_RAM[0x5A] = source_end;       internal_RAM[0x5B] = source_end >> 8;
+    internal_RAM[0x58] = destination_end;  internal_RAM[0x59] = destination_end >> 8;
+    return 1;
+}
+
+int main(int argc, char **argv) {
+  long runs = (argc>1) ? atol(argv[1]) : 20000;
+  long bad=0;
+  long count[CASES];
+  long i;
+  uint32_t address;
+  uint8_t kind;
+
+    load_roms();
+    srand(6);
+    for (kind=0; kind<CASES; kind++) {
+      count[kind] = 0;
+      for (i=0; i<runs; i++) {
+        random_state();
+        for (address=0x200; address<0xA000; address+=1+rand()%64) internal_RAM[address] = rb();
+        if (!random_block(kind)) continue;
+        count[kind]++;
+
+        if (kind==CASE_WRAP) {                                         // The ROM would copy through all of memory
+          save_state();
+          if (native_bltu()!=NATIVE_DECLINE) {
+            printf("A3BF moved a wrapping block\n");
+            bad++;
+          }
+          restore_state();
+          continue;
+        }
+        if (compare_run(0xA3BF, native_bltu)<0) bad++;
+      }
+      printf("A3BF %s: %ld runs\n", case_names[kind], count[kind]);
+    }
+    printf("mismatches=%ld\n", bad);
+    return (bad!=0);
+}